@@ -10,6 +10,9 @@ namespace QAK {
     void ActionContextPrivate::init() {
     }
 
+    void ActionContextPrivate::registryChanged() {
+    }
+
     ActionContext::ActionContext(QObject *parent)
         : ActionContext(*new ActionContextPrivate(), parent) {
     }
@@ -21,6 +24,28 @@ namespace QAK {
         return d->registry;
     }
 
+    QString ActionContext::iconTheme() const {
+        Q_D(const ActionContext);
+        return d->iconTheme;
+    }
+
+    void ActionContext::setIconTheme(const QString &theme) {
+        Q_D(ActionContext);
+        if (d->iconTheme == theme) {
+            return;
+        }
+        d->iconTheme = theme;
+        emit iconThemeChanged();
+        if (d->registry) {
+            updateElement(AE_Icons);
+        }
+    }
+
+    void ActionContext::updateActions(ActionElement element, const QStringList &ids) {
+        Q_UNUSED(ids);
+        updateElement(element);
+    }
+
     ActionContext::ActionContext(ActionContextPrivate &d, QObject *parent)
         : QObject(parent), d_ptr(&d) {
         d.q_ptr = this;
@@ -20,7 +20,18 @@ namespace QAK {
 
         ActionRegistry *registry() const;
 
+        /// Returns the icon theme used to resolve the action icons of this context.
+        QString iconTheme() const;
+        /// Sets the icon theme and updates the icons of this context.
+        void setIconTheme(const QString &theme);
+
         virtual void updateElement(ActionElement element) = 0;
+        /// Updates \a element of the given actions only, the default implementation updates the
+        /// whole element.
+        virtual void updateActions(ActionElement element, const QStringList &ids);
+
+    Q_SIGNALS:
+        void iconThemeChanged();
 
     protected:
         ActionContext(ActionContextPrivate &d, QObject *parent = nullptr);
@@ -22,9 +22,13 @@ namespace QAK {
 
         void init();
 
+        // Called after the context was added to or removed from a registry
+        virtual void registryChanged();
+
         ActionContext *q_ptr;
 
         ActionRegistry *registry = nullptr;
+        QString iconTheme;
     };
 
 }
@@ -71,6 +71,13 @@ namespace QAK {
             return m_type != Action || !m_id.isEmpty();
         }
 
+        inline bool operator==(const ActionLayoutEntry &other) const {
+            return m_id == other.m_id && m_type == other.m_type;
+        }
+        inline bool operator!=(const ActionLayoutEntry &other) const {
+            return !(*this == other);
+        }
+
     protected:
         QString m_id;
         Type m_type;
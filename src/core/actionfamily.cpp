@@ -1,10 +1,13 @@
 #include "actionfamily.h"
 #include "actionfamily_p.h"
+#include "actionicon_p.h"
 
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
+#include <functional>
 #include <utility>
 
 #include <qmxmladaptor/qmxmladaptor.h>
@@ -14,7 +17,8 @@
 
 namespace QAK {
 
-    ActionIcon ActionIconFromJson(const QJsonValue &json, const QUrl &baseUrl);
+    ActionIcon ActionIconFromJson(const QJsonValue &json, const QUrl &baseUrl,
+                                  const std::function<QUrl(const QUrl &)> &mapUrl);
 
     class IconConfigParser {
     public:
@@ -75,9 +79,17 @@ namespace QAK {
                     themeId = it->toString();
                 }
 
+                if (auto it = themeObj.find(QStringLiteral("inherits"));
+                    it != themeObj.end() && it->isString()) {
+                    fallbacks.insert(themeId, it->toString());
+                }
+
                 QJsonArray iconArr;
                 if (auto it = themeObj.find(QStringLiteral("icons"));
                     it == themeObj.end() || !it->isArray()) {
+                    if (fallbacks.contains(themeId)) {
+                        result.insert(themeId, {});
+                    }
                     continue;
                 } else {
                     iconArr = it->toArray();
@@ -101,7 +113,10 @@ namespace QAK {
                     if (auto it = iconObj.find(QStringLiteral("icon")); it == iconObj.end()) {
                         continue;
                     } else {
-                        icon = ActionIconFromJson(it.value(), baseUrl);
+                        icon = ActionIconFromJson(it.value(), baseUrl, mapUrl);
+                    }
+                    if (iconCache) {
+                        ActionIconCache::attach(icon, iconCache);
                     }
                     icons.insert(iconId, icon);
                 }
@@ -128,13 +143,18 @@ namespace QAK {
 
         // config
         QUrl baseUrl;
+        std::function<QUrl(const QUrl &)> mapUrl;
+        QSharedPointer<ActionIconCache> iconCache;
+
+        // result
+        QHash<QString, QString> fallbacks; // theme -> base theme
     };
 
 }
 
 namespace QAK {
 
-    ActionFamilyPrivate::ActionFamilyPrivate() {
+    ActionFamilyPrivate::ActionFamilyPrivate() : iconCache(new ActionIconCache()) {
     }
 
     ActionFamilyPrivate::~ActionFamilyPrivate() = default;
@@ -142,6 +162,17 @@ namespace QAK {
     void ActionFamilyPrivate::init() {
     }
 
+    void ActionFamilyPrivate::overriddenShortcutsChanged(const QStringList &ids) {
+        Q_UNUSED(ids);
+    }
+
+    void ActionFamilyPrivate::overriddenIconsChanged(const QStringList &ids) {
+        Q_UNUSED(ids);
+    }
+
+    void ActionFamilyPrivate::iconStorageChanged() {
+    }
+
     ActionFamily::ActionFamily(QObject *parent) : ActionFamily(*new ActionFamilyPrivate(), parent) {
     }
 
@@ -152,6 +183,8 @@ namespace QAK {
         if (changes.empty())
             return;
 
+        QSet<QString> changedThemes;
+        bool iconsRemoved = false;
         for (const auto &pair : std::as_const(changes)) {
             auto &c = pair.second;
 
@@ -159,6 +192,7 @@ namespace QAK {
                 case 0: {
                     auto &singles = iconStorage.singles;
                     auto &itemToBeChanged = std::get<0>(c);
+                    changedThemes.insert(itemToBeChanged.theme);
                     if (itemToBeChanged.remove) {
                         auto it = singles.find(itemToBeChanged.theme);
                         if (it != singles.end()) {
@@ -168,6 +202,7 @@ namespace QAK {
                                     singles.erase(it);
                                 }
                                 storeOrder.remove({itemToBeChanged.theme, itemToBeChanged.id});
+                                iconsRemoved = true;
                             }
                         }
                     } else {
@@ -181,15 +216,16 @@ namespace QAK {
                 case 1: {
                     auto &configFiles = iconStorage.configFiles;
                     auto &itemToBeChanged = std::get<1>(c);
+                    const auto oldThemes = configFiles.value(itemToBeChanged.fileName).keys();
+                    changedThemes.unite(QSet<QString>(oldThemes.begin(), oldThemes.end()));
                     if (itemToBeChanged.remove) {
+                        iconStorage.configFallbacks.remove(itemToBeChanged.fileName);
                         if (configFiles.remove(itemToBeChanged.fileName)) {
                             storeOrder.remove({itemToBeChanged.fileName});
+                            iconsRemoved = true;
                         }
-                    } else if (auto iconsFromFile =
-                                   IconConfigParser(itemToBeChanged.fileName).parse();
-                               !iconsFromFile.isEmpty()) {
+                    } else if (parseIconManifest(itemToBeChanged.fileName, changedThemes)) {
                         QStringList keys = {itemToBeChanged.fileName};
-                        configFiles[itemToBeChanged.fileName] = iconsFromFile;
                         storeOrder.remove(keys);
                         storeOrder.append(keys, {});
                     }
@@ -197,6 +233,10 @@ namespace QAK {
                 }
                 case 2: {
                     iconStorage = {};
+                    storeOrder.clear();
+                    resolvedIcons.clear();
+                    iconDeduplication.clear();
+                    iconsRemoved = true;
                     break;
                 }
                 default:
@@ -205,13 +245,30 @@ namespace QAK {
         }
         changes.clear();
 
+        if (iconsRemoved) {
+            iconCache->clear();
+            // The remaining manifests may map their files to the files of a removed manifest,
+            // they are hashed again in their order
+            if (iconDeduplication.enabled && !iconStorage.configFiles.isEmpty()) {
+                iconDeduplication.clear();
+                for (const auto &pair : std::as_const(storeOrder)) {
+                    if (pair.first.size() == 1) {
+                        parseIconManifest(pair.first[0], changedThemes);
+                    }
+                }
+            }
+        }
+
         // Build map
         {
             auto &storage = iconStorage.storage;
+            auto &fallbacks = iconStorage.fallbacks;
             storage.clear();
+            fallbacks.clear();
             for (const auto &pair : std::as_const(storeOrder)) {
                 auto &keys = pair.first;
                 if (keys.size() == 1) {
+                    fallbacks.insert(iconStorage.configFallbacks.value(keys[0]));
                     auto configMap = iconStorage.configFiles.value(keys[0]);
                     for (auto it = configMap.begin(); it != configMap.end(); ++it) {
                         auto &from = it.value();
@@ -225,6 +282,132 @@ namespace QAK {
                 }
             }
         }
+
+        invalidateResolvedIcons(changedThemes);
+    }
+
+    bool ActionFamilyPrivate::parseIconManifest(const QString &fileName,
+                                                QSet<QString> &changedThemes) const {
+        IconConfigParser parser(fileName);
+        parser.iconCache = iconCache;
+        if (iconDeduplication.enabled) {
+            parser.mapUrl = [this](const QUrl &url) {
+                return iconDeduplication.canonicalUrl(url);
+            };
+        }
+        auto iconsFromFile = parser.parse();
+        if (iconsFromFile.isEmpty()) {
+            return false;
+        }
+        for (auto it = iconsFromFile.begin(); it != iconsFromFile.end(); ++it) {
+            changedThemes.insert(it.key());
+        }
+        iconStorage.configFiles[fileName] = iconsFromFile;
+        iconStorage.configFallbacks[fileName] = parser.fallbacks;
+        return true;
+    }
+
+    bool ActionFamilyPrivate::IconDeduplication::isCurrent(const QString &fileName) const {
+        auto it = files.find(fileName);
+        if (it == files.end()) {
+            return false;
+        }
+        const QFileInfo info(fileName);
+        return info.exists() && info.lastModified() == it->modified && info.size() == it->size;
+    }
+
+    void ActionFamilyPrivate::IconDeduplication::clear() {
+        files.clear();
+        contents.clear();
+        statistics = {};
+    }
+
+    QUrl ActionFamilyPrivate::IconDeduplication::canonicalUrl(const QUrl &url) {
+        if (!url.isLocalFile()) {
+            return url;
+        }
+        const auto fileName = url.toLocalFile();
+
+        // A mapping holds while neither the file nor its canonical file have changed
+        if (isCurrent(fileName)) {
+            const auto &record = files[fileName];
+            if (record.canonical == fileName) {
+                return url;
+            }
+            if (isCurrent(record.canonical) && files[record.canonical].hash == record.hash) {
+                return QUrl::fromLocalFile(record.canonical);
+            }
+        }
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            // Keep the url, the icon engine reports the missing file later
+            files.remove(fileName);
+            return url;
+        }
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(&file);
+        const auto size = file.size();
+        file.close();
+
+        File record{fileName, hash.result(), QFileInfo(fileName).lastModified(), size};
+        statistics.fileCount++;
+        statistics.totalBytes += size;
+
+        auto it = contents.find(record.hash);
+        if (it != contents.end() && it.value() != fileName && isCurrent(it.value()) &&
+            files[it.value()].hash == record.hash) {
+            record.canonical = it.value();
+            statistics.savedBytes += size;
+        } else {
+            // The previous canonical file of this content has changed or is gone
+            contents.insert(record.hash, fileName);
+            statistics.uniqueFileCount++;
+        }
+        const auto canonical = record.canonical;
+        files.insert(fileName, record);
+        return canonical == fileName ? url : QUrl::fromLocalFile(canonical);
+    }
+
+    QString ActionFamilyPrivate::iconThemeFallback(const QString &theme) const {
+        if (auto it = iconThemeFallbacks.find(theme); it != iconThemeFallbacks.end()) {
+            return it.value();
+        }
+        return iconStorage.fallbacks.value(theme);
+    }
+
+    QStringList ActionFamilyPrivate::iconThemeChain(const QString &theme) const {
+        QStringList chain;
+        QString current = theme;
+        while (!chain.contains(current)) {
+            chain.append(current);
+            current = iconThemeFallback(current);
+            if (current.isEmpty()) {
+                break;
+            }
+        }
+        return chain;
+    }
+
+    void ActionFamilyPrivate::invalidateResolvedIcons(const QSet<QString> &themes) const {
+        if (themes.isEmpty()) {
+            return;
+        }
+        // Drop the memoized layers of the changed themes and of all themes inheriting them
+        for (auto it = resolvedIcons.begin(); it != resolvedIcons.end();) {
+            bool affected = false;
+            for (const auto &theme : iconThemeChain(it.key())) {
+                if (themes.contains(theme)) {
+                    affected = true;
+                    break;
+                }
+            }
+            if (affected) {
+                it = resolvedIcons.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
 
     void ActionFamily::addIcon(const QString &theme, const QString &id, const ActionIcon &icon) {
@@ -239,6 +422,7 @@ namespace QAK {
         QStringList keys = {theme, id};
         items.remove(keys);
         items.append(keys, {itemToBeAdded});
+        d->iconStorageChanged();
     }
 
     void ActionFamily::addIconManifest(const QString &fileName) {
@@ -256,6 +440,7 @@ namespace QAK {
         QStringList keys = {canonicalFileName};
         items.remove(keys);
         items.append({canonicalFileName}, {itemToBeAdded});
+        d->iconStorageChanged();
     }
 
     void ActionFamily::removeIcon(const QString &theme, const QString &id) {
@@ -270,6 +455,7 @@ namespace QAK {
         QStringList keys = {theme, id};
         items.remove(keys);
         items.append(keys, itemToBeRemoved);
+        d->iconStorageChanged();
     }
 
     void ActionFamily::removeIconManifest(const QString &fileName) {
@@ -287,6 +473,7 @@ namespace QAK {
         QStringList keys = {canonicalFileName};
         items.remove(keys);
         items.append(keys, itemToBeRemoved);
+        d->iconStorageChanged();
     }
 
     void ActionFamily::removeAllIcons() {
@@ -296,6 +483,7 @@ namespace QAK {
         ActionFamilyPrivate::IconChange::All itemToBeRemoved;
         items.remove(keys);
         items.append(keys, itemToBeRemoved);
+        d->iconStorageChanged();
     }
 
     QStringList ActionFamily::iconThemes() const {
@@ -316,6 +504,71 @@ namespace QAK {
         return d->iconStorage.storage.value(theme).value(iconId);
     }
 
+    QString ActionFamily::iconThemeFallback(const QString &theme) const {
+        Q_D(const ActionFamily);
+        d->flushIcons();
+        return d->iconThemeFallback(theme);
+    }
+
+    void ActionFamily::setIconThemeFallback(const QString &theme, const QString &baseTheme) {
+        Q_D(ActionFamily);
+        d->flushIcons();
+        d->invalidateResolvedIcons({theme});
+        if (baseTheme.isEmpty()) {
+            d->iconThemeFallbacks.remove(theme);
+        } else {
+            d->iconThemeFallbacks.insert(theme, baseTheme);
+        }
+        d->iconStorageChanged();
+    }
+
+    QStringList ActionFamily::iconThemeChain(const QString &theme) const {
+        Q_D(const ActionFamily);
+        d->flushIcons();
+        return d->iconThemeChain(theme);
+    }
+
+    ActionIcon ActionFamily::resolveIcon(const QString &theme, const QString &iconId) const {
+        Q_D(const ActionFamily);
+        d->flushIcons();
+
+        auto &layer = d->resolvedIcons[theme];
+        if (auto it = layer.find(iconId); it != layer.end()) {
+            return it.value();
+        }
+
+        ActionIcon result;
+        for (const auto &t : d->iconThemeChain(theme)) {
+            const auto &icons = d->iconStorage.storage.value(t);
+            if (auto it = icons.find(iconId); it != icons.end()) {
+                result = it.value();
+                break;
+            }
+        }
+        layer.insert(iconId, result);
+        return result;
+    }
+
+    bool ActionFamily::isIconDeduplicationEnabled() const {
+        Q_D(const ActionFamily);
+        return d->iconDeduplication.enabled;
+    }
+
+    void ActionFamily::setIconDeduplicationEnabled(bool enabled) {
+        Q_D(ActionFamily);
+        auto &dedup = d->iconDeduplication;
+        dedup.enabled = enabled;
+        if (!enabled) {
+            dedup.clear();
+        }
+    }
+
+    ActionFamily::IconDeduplicationStatistics ActionFamily::iconDeduplicationStatistics() const {
+        Q_D(const ActionFamily);
+        d->flushIcons();
+        return d->iconDeduplication.statistics;
+    }
+
     ActionFamily::ShortcutsFamily ActionFamily::shortcutsFamily() const {
         Q_D(const ActionFamily);
         return d->overriddenShortcuts;
@@ -323,12 +576,25 @@ namespace QAK {
 
     void ActionFamily::setShortcutsFamily(const ShortcutsFamily &shortcutsFamily) {
         Q_D(ActionFamily);
+        QStringList changedIds;
+        for (auto it = d->overriddenShortcuts.begin(); it != d->overriddenShortcuts.end(); ++it) {
+            if (shortcutsFamily.value(it.key()) != it.value()) {
+                changedIds.append(it.key());
+            }
+        }
+        for (auto it = shortcutsFamily.begin(); it != shortcutsFamily.end(); ++it) {
+            if (!d->overriddenShortcuts.contains(it.key()) && it.value()) {
+                changedIds.append(it.key());
+            }
+        }
         d->overriddenShortcuts = shortcutsFamily;
+        if (!changedIds.isEmpty()) {
+            d->overriddenShortcutsChanged(changedIds);
+        }
     }
 
     void ActionFamily::resetShortcuts() {
-        Q_D(ActionFamily);
-        d->overriddenShortcuts.clear();
+        setShortcutsFamily({});
     }
 
     ActionFamily::ShortcutsOverride ActionFamily::shortcuts(const QString &id) const {
@@ -338,7 +604,12 @@ namespace QAK {
 
     void ActionFamily::setShortcuts(const QString &id, const ShortcutsOverride &shortcuts) {
         Q_D(ActionFamily);
+        if (d->overriddenShortcuts.value(id) == shortcuts) {
+            d->overriddenShortcuts.insert(id, shortcuts);
+            return;
+        }
         d->overriddenShortcuts.insert(id, shortcuts);
+        d->overriddenShortcutsChanged({id});
     }
 
     ActionFamily::IconFamily ActionFamily::iconFamily() const {
@@ -348,7 +619,17 @@ namespace QAK {
 
     void ActionFamily::setIconFamily(const IconFamily &iconFamily) {
         Q_D(ActionFamily);
+        // Icons are not comparable, every id present before or after is reported
+        QStringList changedIds = d->overriddenIcons.keys();
+        for (auto it = iconFamily.begin(); it != iconFamily.end(); ++it) {
+            if (!d->overriddenIcons.contains(it.key())) {
+                changedIds.append(it.key());
+            }
+        }
         d->overriddenIcons = iconFamily;
+        if (!changedIds.isEmpty()) {
+            d->overriddenIconsChanged(changedIds);
+        }
     }
 
     ActionFamily::IconOverride ActionFamily::icon(const QString &id) const {
@@ -359,11 +640,11 @@ namespace QAK {
     void ActionFamily::setIcon(const QString &id, const IconOverride &icon) {
         Q_D(ActionFamily);
         d->overriddenIcons.insert(id, icon);
+        d->overriddenIconsChanged({id});
     }
 
     void ActionFamily::resetIcons() {
-        Q_D(ActionFamily);
-        d->overriddenIcons.clear();
+        setIconFamily({});
     }
 
     QJsonArray ActionFamily::shortcutsFamilyToJson(const ShortcutsFamily &shortcutsFamily) {
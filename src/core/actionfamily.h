@@ -28,6 +28,13 @@ namespace QAK {
         using ShortcutsFamily = QMap<QString, ShortcutsOverride>;
         using IconFamily = QMap<QString, IconOverride>;
 
+        struct IconDeduplicationStatistics {
+            int fileCount = 0;       // local files hashed
+            int uniqueFileCount = 0; // distinct contents among them
+            qint64 totalBytes = 0;
+            qint64 savedBytes = 0; // bytes of the files mapped to another canonical file
+        };
+
     public:
         /// This set of functions is used to query or modify the base icon collection of the
         /// \c ActionFamily.
@@ -45,6 +52,7 @@ namespace QAK {
         ///     "themes": [
         ///         {
         ///             "id": "theme1",
+        ///             "inherits": "base", // optional fallback theme
         ///             "icons": [
         ///                 {
         ///                     "id": "icon1",
@@ -76,6 +84,28 @@ namespace QAK {
         QStringList iconIds(const QString &theme);
         ActionIcon icon(const QString &theme, const QString &iconId) const;
 
+        /// Returns the base theme which \a theme falls back to, the value set in code takes
+        /// precedence over the \c inherits field of the icon manifests.
+        QString iconThemeFallback(const QString &theme) const;
+        /// Sets the base theme which \a theme falls back to, an empty \a baseTheme removes it.
+        void setIconThemeFallback(const QString &theme, const QString &baseTheme);
+        /// Returns the fallback chain of \a theme, starting with the theme itself.
+        QStringList iconThemeChain(const QString &theme) const;
+        /// Returns the icon of \a iconId in the first theme of the fallback chain of \a theme
+        /// that provides it, the results are memoized until a theme in the chain changes.
+        ActionIcon resolveIcon(const QString &theme, const QString &iconId) const;
+
+        /// Returns whether the icon files are de-duplicated by content while loading manifests.
+        bool isIconDeduplicationEnabled() const;
+        /// Enables hashing the local icon files of the manifests loaded afterwards, the files with
+        /// identical content are mapped to the URL of the first one so that the icons share their
+        /// rasterization caches. A mapping is hashed again once either file has changed, and
+        /// the remaining manifests are mapped again when a manifest is removed. Disabling it
+        /// drops the hash table.
+        void setIconDeduplicationEnabled(bool enabled);
+        /// Returns the savings of the de-duplication so far.
+        IconDeduplicationStatistics iconDeduplicationStatistics() const;
+
     public:
         /// Returns the current keymap.
         ShortcutsFamily shortcutsFamily() const;
@@ -118,7 +148,7 @@ namespace QAK {
         if (const auto o = icon(id); o) {
             return o.value();
         }
-        return icon(theme, id);
+        return resolveIcon(theme, id);
     }
 
 }
@@ -12,6 +12,10 @@
 
 #include <variant>
 
+#include <QtCore/QDateTime>
+#include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
+
 #include <QAKCore/actionfamily.h>
 #include <QAKCore/private/qakglobal_p.h>
 
@@ -19,6 +23,8 @@
 
 namespace QAK {
 
+    class ActionIconCache;
+
     class QAK_CORE_EXPORT ActionFamilyPrivate {
         Q_DECLARE_PUBLIC(ActionFamily)
     public:
@@ -50,16 +56,56 @@ namespace QAK {
             QHash<QString, QHash<QString, ActionIcon>> singles; // theme -> [id -> icon]
             QHash<QString, QHash<QString, QHash<QString, ActionIcon>>>
                 configFiles; // configFile -> [theme -> [id -> icon]]
+            QHash<QString, QHash<QString, QString>>
+                configFallbacks;                                 // configFile -> [theme -> base]
             QHash<QString, QHash<QString, ActionIcon>> storage; // theme -> [id -> icon]
+            QHash<QString, QString> fallbacks;                  // theme -> base
         };
         mutable IconChange iconChange;
         mutable IconStorage iconStorage;
         mutable stdc::linked_map<QStringList, int /* NOT USED */> storeOrder;
 
+        QHash<QString, QString> iconThemeFallbacks;                       // theme -> base
+        mutable QHash<QString, QHash<QString, ActionIcon>> resolvedIcons; // theme -> [id -> icon]
+
+        struct IconDeduplication {
+            struct File {
+                QString canonical; // the first file hashed with the same content
+                QByteArray hash;
+                QDateTime modified;
+                qint64 size;
+            };
+            bool enabled = false;
+            QHash<QString, File> files;           // local file -> record
+            QHash<QByteArray, QString> contents; // content hash -> canonical file
+            ActionFamily::IconDeduplicationStatistics statistics;
+
+            QUrl canonicalUrl(const QUrl &url);
+            bool isCurrent(const QString &fileName) const;
+            void clear();
+        };
+        mutable IconDeduplication iconDeduplication;
+
+        // The QIcons shared by the icons of the manifests
+        QSharedPointer<ActionIconCache> iconCache;
+
         ActionFamily::ShortcutsFamily overriddenShortcuts;
         ActionFamily::IconFamily overriddenIcons;
 
         void flushIcons() const;
+        bool parseIconManifest(const QString &fileName, QSet<QString> &changedThemes) const;
+
+        QString iconThemeFallback(const QString &theme) const;
+        QStringList iconThemeChain(const QString &theme) const;
+        void invalidateResolvedIcons(const QSet<QString> &themes) const;
+
+        /// Called after the overridden shortcuts of \a ids have been changed, subclasses may
+        /// update their derived keymap data incrementally.
+        virtual void overriddenShortcutsChanged(const QStringList &ids);
+        /// Called after the overridden icons of \a ids have been changed.
+        virtual void overriddenIconsChanged(const QStringList &ids);
+        /// Called after the base icon collection or the theme fallbacks have been changed.
+        virtual void iconStorageChanged();
     };
 
 }
@@ -1,28 +1,174 @@
 #include "actionicon.h"
+#include "actionicon_p.h"
+
+#include <functional>
 
 #include <QtCore/QJsonArray>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutex>
 
 #include <util/util.h>
 
 namespace QAK {
 
+    // Guards the lazy build of the QIcon shared by the copies of an icon
+    static QBasicMutex iconMutex;
+
     static inline bool isEffectiveUrl(const QUrl &url) {
         return url.isValid() && !url.isEmpty();
     }
 
-    class ActionIconPrivate : public QSharedData {
-    public:
+    ActionIconUrlPool *ActionIconUrlPool::instance() {
+        // Never destroyed, the icons held by other static objects release into it on exit
+        static const auto pool = new ActionIconUrlPool();
+        return pool;
+    }
+
+    quint32 ActionIconUrlPool::intern(const QUrl &url) {
+        if (!isEffectiveUrl(url)) {
+            return 0;
+        }
+        QWriteLocker locker(&lock);
+        if (auto it = indexes.find(url); it != indexes.end()) {
+            entries[int(it.value()) - 1].refs++;
+            return it.value();
+        }
+        quint32 index;
+        if (!freeIndexes.isEmpty()) {
+            index = freeIndexes.takeLast();
+        } else {
+            entries.append({});
+            index = quint32(entries.size());
+        }
+        entries[int(index) - 1] = {url, 1};
+        indexes.insert(url, index);
+        return index;
+    }
+
+    void ActionIconUrlPool::retain(quint32 index) {
+        if (index == 0) {
+            return;
+        }
+        QWriteLocker locker(&lock);
+        entries[int(index) - 1].refs++;
+    }
+
+    void ActionIconUrlPool::release(quint32 index) {
+        if (index == 0) {
+            return;
+        }
+        QWriteLocker locker(&lock);
+        auto &entry = entries[int(index) - 1];
+        if (--entry.refs > 0) {
+            return;
+        }
+        indexes.remove(entry.url);
+        entry.url = QUrl();
+        freeIndexes.append(index);
+    }
+
+    QUrl ActionIconUrlPool::url(quint32 index) const {
+        if (index == 0) {
+            return {};
+        }
+        QReadLocker locker(&lock);
+        return entries.value(int(index) - 1).url;
+    }
+
+    int ActionIconUrlPool::size() const {
+        QReadLocker locker(&lock);
+        return int(indexes.size());
+    }
+
+    ActionIconPrivate::ActionIconPrivate(const ActionIconPrivate &other)
+        : QSharedData(other), icon(other.icon), iconBuilt(other.iconBuilt.loadAcquire()),
+          currentColor(other.currentColor), explicitStates(other.explicitStates),
+          flags(other.flags), cache(other.cache) {
+        const auto pool = ActionIconUrlPool::instance();
+        for (int i = 0; i < 4; ++i) {
+            const bool enabled = i & 2;
+            const bool checked = i & 1;
+            urls[enabled][checked] = other.urls[enabled][checked];
+            sizes[enabled][checked] = other.sizes[enabled][checked];
+            pool->retain(urls[enabled][checked]);
+        }
+    }
+
+    ActionIconPrivate::~ActionIconPrivate() {
+        const auto pool = ActionIconUrlPool::instance();
+        for (int i = 0; i < 4; ++i) {
+            pool->release(urls[i >> 1][i & 1]);
+        }
+    }
+
+    static QIcon buildIcon(const ActionIconPrivate &d) {
+        const auto pool = ActionIconUrlPool::instance();
         QIcon icon;
-        QString currentColor;
+        for (int i = 0; i < 4; ++i) {
+            const bool enabled = i & 2;
+            const bool checked = i & 1;
+            if (!(d.explicitStates & ActionIconPrivate::stateBit(enabled, checked))) {
+                continue;
+            }
+            const auto url = pool->url(d.urls[enabled][checked]);
+            if (url.isLocalFile())
+                icon.addFile(url.toLocalFile(), d.sizes[enabled][checked],
+                             enabled ? QIcon::Normal : QIcon::Disabled,
+                             checked ? QIcon::On : QIcon::Off);
+        }
+        return icon;
+    }
 
-        struct AddFileInfo {
-            QUrl url;
-            QSize size;
-        };
+    QIcon ActionIconCache::icon(const ActionIconPrivate &d) {
+        QByteArray key;
+        key.reserve(4 * (1 + 3 * int(sizeof(quint32))));
+        for (int i = 0; i < 4; ++i) {
+            const bool enabled = i & 2;
+            const bool checked = i & 1;
+            if (!(d.explicitStates & ActionIconPrivate::stateBit(enabled, checked))) {
+                continue;
+            }
+            const quint32 data[] = {
+                d.urls[enabled][checked],
+                quint32(d.sizes[enabled][checked].width()),
+                quint32(d.sizes[enabled][checked].height()),
+            };
+            key.append(char(i));
+            key.append(reinterpret_cast<const char *>(data), sizeof(data));
+        }
+        {
+            QReadLocker locker(&lock);
+            if (auto it = icons.find(key); it != icons.end()) {
+                return it.value();
+            }
+        }
+
+        const auto icon = buildIcon(d);
+
+        QWriteLocker locker(&lock);
+        if (auto it = icons.find(key); it != icons.end()) {
+            return it.value();
+        }
+        icons.insert(key, icon);
+        return icon;
+    }
+
+    int ActionIconCache::size() const {
+        QReadLocker locker(&lock);
+        return icons.size();
+    }
 
-        AddFileInfo files[2][2]; // [enabled][checked]
-    };
+    void ActionIconCache::clear() {
+        QWriteLocker locker(&lock);
+        icons.clear();
+    }
+
+    void ActionIconCache::attach(ActionIcon &icon, const QSharedPointer<ActionIconCache> &cache) {
+        auto &d = *icon.d_ptr;
+        d.cache = cache;
+        d.icon = QIcon();
+        d.iconBuilt.storeRelaxed(0);
+    }
 
     ActionIcon::ActionIcon() : d_ptr(new ActionIconPrivate()) {
     }
@@ -34,44 +180,67 @@ namespace QAK {
     ActionIcon &ActionIcon::operator=(ActionIcon &&other) noexcept = default;
 
     QUrl ActionIcon::url(bool enabled, bool checked) const {
-        return d_ptr->files[enabled][checked].url;
+        return ActionIconUrlPool::instance()->url(d_ptr->urls[enabled][checked]);
     }
 
     QSize ActionIcon::size(bool enabled, bool checked) const {
-        return d_ptr->files[enabled][checked].size;
+        return d_ptr->sizes[enabled][checked];
     }
 
     void ActionIcon::addUrl(const QUrl &url, QSize size, bool enabled, bool checked) {
         auto &d = *d_ptr;
-        d.files[enabled][checked] = {url, size};
+        const auto pool = ActionIconUrlPool::instance();
+        const auto index = pool->intern(url);
+        const auto setFile = [&d, pool, index, size](bool enabled, bool checked) {
+            pool->retain(index);
+            pool->release(d.urls[enabled][checked]);
+            d.urls[enabled][checked] = index;
+            d.sizes[enabled][checked] = size;
+        };
+        setFile(enabled, checked);
 
         if (!checked) {
             // set unchecked-enabled icon if not set
-            if (!enabled && !isEffectiveUrl(d.files[true][false].url)) {
-                d.files[true][false] = {url, size};
+            if (!enabled && d.urls[true][false] == 0) {
+                setFile(true, false);
             }
         } else {
             // set unchecked-enabled icon if not set
-            if (!isEffectiveUrl(d.files[true][false].url)) {
-                d.files[true][false] = {url, size};
+            if (d.urls[true][false] == 0) {
+                setFile(true, false);
             }
 
             // set checked-disabled icon if not set
-            if (!enabled && !isEffectiveUrl(d.files[false][true].url)) {
-                d.files[false][true] = {url, size};
+            if (!enabled && d.urls[false][true] == 0) {
+                setFile(false, true);
             }
         }
+
+        pool->release(index); // the slots hold their own references
+
+        // The QIcon is built lazily from the states added explicitly
+        d.explicitStates |= ActionIconPrivate::stateBit(enabled, checked);
+        d.icon = QIcon();
+        d.iconBuilt.storeRelaxed(0);
         if (url.isLocalFile())
-            d.icon.addFile(url.toLocalFile(), size, enabled ? QIcon::Normal : QIcon::Disabled,
-                           checked ? QIcon::On : QIcon::Off);
+            d.flags |= ActionIconPrivate::HasLocalFile;
     }
 
     QIcon ActionIcon::icon() const {
-        return d_ptr->icon;
+        const auto &d = *d_ptr;
+        if (!d.iconBuilt.loadAcquire()) {
+            QMutexLocker locker(&iconMutex);
+            if (!d.iconBuilt.loadRelaxed()) {
+                const auto cache = d.cache.toStrongRef();
+                d.icon = cache ? cache->icon(d) : buildIcon(d);
+                d.iconBuilt.storeRelease(1);
+            }
+        }
+        return d.icon;
     }
 
     bool ActionIcon::isNull() const {
-        return d_ptr->icon.isNull();
+        return !(d_ptr->flags & ActionIconPrivate::HasLocalFile);
     }
 
     QString ActionIcon::currentColor() const {
@@ -90,35 +259,36 @@ namespace QAK {
             obj["currentColor"] = d.currentColor;
         }
 
-        const auto &toObject = [](const ActionIconPrivate::AddFileInfo &info) {
+        const auto &toObject = [&d](bool enabled, bool checked) {
+            const auto &size = d.sizes[enabled][checked];
             QJsonObject obj;
-            obj["url"] = info.url.toString();
-            if (!info.size.isEmpty()) {
+            obj["url"] = ActionIconUrlPool::instance()->url(d.urls[enabled][checked]).toString();
+            if (!size.isEmpty()) {
                 QJsonObject sizeObj;
-                sizeObj["width"] = info.size.width();
-                sizeObj["height"] = info.size.height();
+                sizeObj["width"] = size.width();
+                sizeObj["height"] = size.height();
                 obj["size"] = sizeObj;
             }
             return obj;
         };
 
         QJsonObject uncheckedObj;
-        if (auto &item = d.files[true][false]; isEffectiveUrl(item.url)) {
-            uncheckedObj["enabled"] = toObject(item);
+        if (d.urls[true][false] != 0) {
+            uncheckedObj["enabled"] = toObject(true, false);
         }
-        if (auto &item = d.files[false][false]; isEffectiveUrl(item.url)) {
-            uncheckedObj["disabled"] = toObject(item);
+        if (d.urls[false][false] != 0) {
+            uncheckedObj["disabled"] = toObject(false, false);
         }
         if (!uncheckedObj.isEmpty()) {
             obj["unchecked"] = uncheckedObj;
         }
 
         QJsonObject checkedObj;
-        if (auto &item = d.files[true][true]; isEffectiveUrl(item.url)) {
-            checkedObj["enabled"] = toObject(item);
+        if (d.urls[true][true] != 0) {
+            checkedObj["enabled"] = toObject(true, true);
         }
-        if (auto &item = d.files[false][true]; isEffectiveUrl(item.url)) {
-            checkedObj["disabled"] = toObject(item);
+        if (d.urls[false][true] != 0) {
+            checkedObj["disabled"] = toObject(false, true);
         }
         if (!checkedObj.isEmpty()) {
             obj["checked"] = checkedObj;
@@ -138,9 +308,15 @@ namespace QAK {
         return {};
     }
 
-    ActionIcon ActionIconFromJson(const QJsonValue &json, const QUrl &baseUrl) {
+    ActionIcon ActionIconFromJson(const QJsonValue &json, const QUrl &baseUrl,
+                                  const std::function<QUrl(const QUrl &)> &mapUrl) {
+        const auto &absoluteUrl = [&](const QString &path) {
+            auto url = Util::absoluteUrl(path, baseUrl);
+            return mapUrl ? mapUrl(url) : url;
+        };
+
         if (json.isString()) {
-            return ActionIcon(Util::absoluteUrl(json.toString(), baseUrl));
+            return ActionIcon(absoluteUrl(json.toString()));
         }
 
         if (json.isObject()) {
@@ -157,7 +333,7 @@ namespace QAK {
             */
             const auto testOne = [&](const QJsonObject &obj, bool enabled, bool checked) {
                 if (auto it = obj.find("url"); it != obj.end() && it->isString()) {
-                    QUrl url = Util::absoluteUrl(it.value().toString(), baseUrl);
+                    QUrl url = absoluteUrl(it.value().toString());
                     QSize size;
                     if (it = obj.find("size"); it != obj.end()) {
                         size = sizeFromJson(it.value());
@@ -180,7 +356,7 @@ namespace QAK {
 
             const auto &testState = [&](const QJsonValue &value, bool checked) {
                 if (value.isString()) {
-                    ai.addUrl(Util::absoluteUrl(value.toString(), baseUrl), {}, true, checked);
+                    ai.addUrl(absoluteUrl(value.toString()), {}, true, checked);
                     return;
                 }
 
@@ -192,8 +368,7 @@ namespace QAK {
 
                     if (auto it = obj2.find("enabled"); it != obj2.end()) {
                         if (it->isString()) {
-                            ai.addUrl(Util::absoluteUrl(it.value().toString(), baseUrl), {}, true,
-                                      checked);
+                            ai.addUrl(absoluteUrl(it.value().toString()), {}, true, checked);
                         } else if (it->isObject()) {
                             const auto &obj3 = it->toObject();
                             std::ignore = testOne(obj3, true, checked);
@@ -202,8 +377,7 @@ namespace QAK {
 
                     if (auto it = obj2.find("disabled"); it != obj2.end()) {
                         if (it->isString()) {
-                            ai.addUrl(Util::absoluteUrl(it.value().toString(), baseUrl), {}, false,
-                                      checked);
+                            ai.addUrl(absoluteUrl(it.value().toString()), {}, false, checked);
                         } else if (it->isObject()) {
                             const auto &obj3 = it->toObject();
                             std::ignore = testOne(obj3, false, checked);
@@ -227,7 +401,7 @@ namespace QAK {
     }
 
     ActionIcon ActionIcon::fromJson(const QJsonValue &json) {
-        return ActionIconFromJson(json, {});
+        return ActionIconFromJson(json, {}, {});
     }
 
 }
@@ -40,6 +40,8 @@ namespace QAK {
 
     protected:
         QSharedDataPointer<ActionIconPrivate> d_ptr;
+
+        friend class ActionIconCache;
     };
 
     inline ActionIcon::ActionIcon(const QUrl &url, QSize size) : ActionIcon() {
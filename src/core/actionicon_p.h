@@ -0,0 +1,104 @@
+#ifndef ACTIONICON_P_H
+#define ACTIONICON_P_H
+
+//
+//  W A R N I N G !!!
+//  -----------------
+//
+// This file is not part of the QActionKit API. It is used purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or may even be removed.
+//
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+
+#include <QAKCore/actionicon.h>
+
+namespace QAK {
+
+    class ActionIconPrivate;
+
+    class ActionIconCache;
+
+    /// Interns the icon URLs so that an \c ActionIcon only stores a small index for each state,
+    /// the index 0 is reserved for the empty URL. Each index is counted by the icons referring
+    /// to it, a URL is evicted and its index reused once the last of them is gone.
+    class QAK_CORE_EXPORT ActionIconUrlPool {
+    public:
+        static ActionIconUrlPool *instance();
+
+        /// Returns the index of \a url with one reference taken.
+        quint32 intern(const QUrl &url);
+        void retain(quint32 index);
+        void release(quint32 index);
+
+        QUrl url(quint32 index) const;
+        int size() const;
+
+    protected:
+        struct Entry {
+            QUrl url;
+            int refs = 0;
+        };
+
+        mutable QReadWriteLock lock;
+        QVector<Entry> entries; // index - 1 -> entry
+        QVector<quint32> freeIndexes;
+        QHash<QUrl, quint32> indexes;
+    };
+
+    /// Shares one \c QIcon between the icons of a family with the same explicit states, so that
+    /// identical glyphs share one rasterization cache. The cache belongs to the family, the
+    /// icons only refer to it weakly and build their own \c QIcon once it is gone.
+    class QAK_CORE_EXPORT ActionIconCache {
+    public:
+        QIcon icon(const ActionIconPrivate &d);
+        int size() const;
+        void clear();
+
+        /// Makes \a icon take its \c QIcon from \a cache.
+        static void attach(ActionIcon &icon, const QSharedPointer<ActionIconCache> &cache);
+
+    protected:
+        mutable QReadWriteLock lock;
+        QHash<QByteArray, QIcon> icons; // explicit states -> icon
+    };
+
+    class ActionIconPrivate : public QSharedData {
+    public:
+        ActionIconPrivate() = default;
+        ActionIconPrivate(const ActionIconPrivate &other);
+        ~ActionIconPrivate();
+
+        ActionIconPrivate &operator=(const ActionIconPrivate &) = delete;
+
+        enum Flag : quint8 {
+            HasLocalFile = 0x1,
+        };
+
+        // Built on the first call of ActionIcon::icon(), the copies of an icon share this data
+        // and may call it from several threads, so the icon is published through iconBuilt
+        mutable QIcon icon;
+        mutable QAtomicInt iconBuilt;
+        QString currentColor;
+
+        quint32 urls[2][2] = {}; // [enabled][checked] -> pool index, each holding a reference
+        QSize sizes[2][2];       // [enabled][checked]
+        quint8 explicitStates = 0; // bit (enabled << 1 | checked) of the states added explicitly
+        quint8 flags = 0;
+
+        QWeakPointer<ActionIconCache> cache;
+
+        static inline int stateBit(bool enabled, bool checked) {
+            return 1 << ((enabled ? 2 : 0) | (checked ? 1 : 0));
+        }
+    };
+
+}
+
+#endif // ACTIONICON_P_H
@@ -21,8 +21,10 @@ namespace QAK {
         // Explicit top-level nodes list
         QVector<ActionLayoutEntry> topLevelNodes;
         
-        // Cache for path-based tree view
+        // Cache for path-based tree view, the ids stay valid across edits so that the
+        // persistent indexes of the unchanged paths survive
         mutable QHash<quintptr, NodePath> pathCache;
+        mutable QHash<NodePath, quintptr> pathIds; // reverse of pathCache
         mutable quintptr nextPathId = 1;
         
         // Reverse mapping: nodeId -> list of paths containing this node
@@ -35,6 +37,7 @@ namespace QAK {
         NodePath pathFromCacheId(quintptr cacheId) const;
         void rebuildCache() const;
         void clearCache();
+        void invalidateNodePaths();
         
         ActionLayoutEntry entryAtPath(const NodePath &path) const;
         QVector<ActionLayoutEntry> childrenAtPath(const NodePath &path) const;
@@ -77,16 +80,14 @@ namespace QAK {
     }
 
     quintptr ActionLayoutsModelPrivate::cachePathId(const NodePath &path) const {
-        // Find existing cache entry
-        for (auto it = pathCache.begin(); it != pathCache.end(); ++it) {
-            if (it.value() == path) {
-                return it.key();
-            }
+        if (auto it = pathIds.constFind(path); it != pathIds.cend()) {
+            return it.value();
         }
         
         // Create new cache entry
         quintptr cacheId = nextPathId++;
         pathCache.insert(cacheId, path);
+        pathIds.insert(path, cacheId);
         return cacheId;
     }
 
@@ -146,11 +147,17 @@ namespace QAK {
 
     void ActionLayoutsModelPrivate::clearCache() {
         pathCache.clear();
+        pathIds.clear();
         nodePathsMap.clear();
         nextPathId = 1;
         cacheValid = false;
     }
 
+    void ActionLayoutsModelPrivate::invalidateNodePaths() {
+        nodePathsMap.clear();
+        cacheValid = false;
+    }
+
     ActionLayoutEntry ActionLayoutsModelPrivate::entryAtPath(const NodePath &path) const {
         if (path.isEmpty()) {
             return ActionLayoutEntry(); // Invalid entry for root
@@ -251,7 +258,8 @@ namespace QAK {
         } else {
             adjacencyMap[nodeId] = newChildren;
         }
-        clearCache(); // Invalidate cache after changes
+        // The path ids are kept, a path that no longer exists is simply never looked up again
+        invalidateNodePaths();
     }
 
     bool ActionLayoutsModelPrivate::validateActionLayoutEntry(const ActionLayoutEntry &entry) const {
@@ -333,8 +341,7 @@ namespace QAK {
             return QModelIndex();
         }
 
-        d->rebuildCache();
-        
+        // The node paths are only needed when renaming, build them lazily in setData()
         NodePath parentPath = d->pathFromIndex(parent);
         auto children = d->childrenAtPath(parentPath);
         
@@ -441,9 +448,9 @@ namespace QAK {
         NodePath path = d->pathFromIndex(index);
         NodePath parentPath = d->parentPath(path);
         
-        // Top-level nodes are read-only
+        // Top-level nodes are read-only, but accept entries
         if (parentPath.isEmpty()) {
-            return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+            return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDropEnabled;
         }
         
         return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled | Qt::ItemIsEditable;
@@ -553,8 +560,7 @@ namespace QAK {
             }
         }
         
-        // Clear cache to reflect changes
-        d->clearCache();
+        d->invalidateNodePaths();
         
         // Emit data changed
         emit dataChanged(index, index, {role});
@@ -679,7 +685,11 @@ namespace QAK {
             }
         }
         
-        beginMoveRows(sourceParent, sourceRow, sourceRow + count - 1, destinationParent, destinationChild);
+        // Rejects the moves onto the rows themselves
+        if (!beginMoveRows(sourceParent, sourceRow, sourceRow + count - 1, destinationParent,
+                           destinationChild)) {
+            return false;
+        }
         
         // Remove from source
         for (int i = 0; i < count; ++i) {
@@ -712,4 +722,9 @@ namespace QAK {
         return true;
     }
 
+    Qt::DropActions ActionLayoutsModel::supportedDropActions() const {
+        // Entries are only moved inside the model, see moveRows()
+        return Qt::MoveAction;
+    }
+
 } // QAK
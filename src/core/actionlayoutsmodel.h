@@ -39,6 +39,7 @@ namespace QAK {
         bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
         bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
                       const QModelIndex &destinationParent, int destinationChild) override;
+        Qt::DropActions supportedDropActions() const override;
 
         // Validation
         bool validateSetData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) const;
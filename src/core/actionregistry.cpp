@@ -1,12 +1,15 @@
 #include "actionregistry.h"
 #include "actionregistry_p.h"
 
+#include <algorithm>
+#include <cmath>
 #include <set>
 #include <utility>
 
 #include <QtCore/QStack>
 #include <QtCore/QQueue>
 #include <QtCore/QJsonArray>
+#include <QtCore/QDataStream>
 
 #include "qakglobal_p.h"
 #include "actioncontext_p.h"
@@ -179,6 +182,38 @@ namespace QAK {
         return ActionLayoutEntry(id, type);
     }
 
+    static void flattenEntry(const QMap<QString, QVector<ActionLayoutEntry>> &adjacencyMap,
+                             const ActionLayoutEntry &entry, QVector<ActionLayoutEntry> &result) {
+        switch (entry.type()) {
+            case ActionLayoutEntry::Separator:
+                // Collapse the leading and adjacent separators, the trailing ones are removed later
+                if (!result.isEmpty() && result.last().type() != ActionLayoutEntry::Separator)
+                    result.append(entry);
+                break;
+            case ActionLayoutEntry::Group:
+                flattenEntry(adjacencyMap, ActionLayoutEntry({}, ActionLayoutEntry::Separator), result);
+                for (const auto &child : adjacencyMap.value(entry.id())) {
+                    flattenEntry(adjacencyMap, child, result);
+                }
+                flattenEntry(adjacencyMap, ActionLayoutEntry({}, ActionLayoutEntry::Separator), result);
+                break;
+            default:
+                result.append(entry);
+                break;
+        }
+    }
+
+    QVector<ActionLayoutEntry> ActionLayouts::flattenedChildren(const QString &id) const {
+        QVector<ActionLayoutEntry> result;
+        for (const auto &child : m_adjacencyMap.value(id)) {
+            flattenEntry(m_adjacencyMap, child, result);
+        }
+        while (!result.isEmpty() && result.last().type() == ActionLayoutEntry::Separator) {
+            result.removeLast();
+        }
+        return result;
+    }
+
     QJsonObject ActionLayouts::toJsonObject() const {
         QJsonObject rootObj;
 
@@ -253,6 +288,188 @@ namespace QAK {
         }
         catalog = defaultCatalog();
         layouts = defaultLayouts();
+        keymapDirty = true;
+        reserveUsage();
+    }
+
+    static QKeySequence keySequencePrefix(const QKeySequence &key, int count) {
+        int keys[4] = {};
+        for (int i = 0; i < count; ++i) {
+            keys[i] = key[i].toCombined();
+        }
+        return QKeySequence(keys[0], keys[1], keys[2], keys[3]);
+    }
+
+    void ActionRegistryPrivate::flushKeymap() const {
+        flushActionItems();
+        if (!keymapDirty)
+            return;
+        keymapDirty = false;
+
+        keymap = {};
+        shortcutIndex = {};
+
+        const int count = int(actionItems.size());
+        keymap.ids.reserve(count);
+        keymap.indexes.reserve(count);
+        keymap.keys.reserve(count);
+        for (auto it = actionItems.begin(); it != actionItems.end(); ++it) {
+            keymap.indexes.insert(it.key(), keymap.ids.size());
+            keymap.ids.append(it.key());
+            keymap.keys.append({});
+        }
+        for (int i = 0; i < count; ++i) {
+            keymap.keys[i] = resolveShortcuts(i);
+            indexShortcuts(i);
+        }
+    }
+
+    QList<QKeySequence> ActionRegistryPrivate::resolveShortcuts(int index) const {
+        const auto &id = keymap.ids.at(index);
+        if (auto it = overriddenShortcuts.find(id); it != overriddenShortcuts.end() && it.value()) {
+            // Shares the storage of the override
+            return *it.value();
+        }
+        // Shares the storage of the extension data
+        return actionItems.value(id).shortcuts();
+    }
+
+    void ActionRegistryPrivate::indexShortcuts(int index) const {
+        const auto &id = keymap.ids.at(index);
+        const auto &keys = keymap.keys.at(index);
+        for (int i = 0; i < keys.size(); ++i) {
+            const auto &key = keys.at(i);
+            if (key.isEmpty() || keys.indexOf(key) < i) {
+                continue;
+            }
+
+            auto &ids = shortcutIndex.keys[key];
+            ids.append(id);
+            if (ids.size() > 1) {
+                shortcutIndex.conflicts.insert(key);
+            }
+
+            // Index all strict chord prefixes, e.g. "Ctrl+K" of "Ctrl+K, Ctrl+S"
+            for (int j = 1; j < key.count(); ++j) {
+                auto &prefixIds = shortcutIndex.prefixes[keySequencePrefix(key, j)];
+                if (!prefixIds.contains(id)) {
+                    prefixIds.append(id);
+                }
+            }
+        }
+    }
+
+    void ActionRegistryPrivate::unindexShortcuts(int index) const {
+        const auto &id = keymap.ids.at(index);
+        const auto &keys = keymap.keys.at(index);
+        for (const auto &key : keys) {
+            if (auto keyIt = shortcutIndex.keys.find(key); keyIt != shortcutIndex.keys.end()) {
+                keyIt->removeAll(id);
+                if (keyIt->size() <= 1) {
+                    shortcutIndex.conflicts.remove(key);
+                }
+                if (keyIt->isEmpty()) {
+                    shortcutIndex.keys.erase(keyIt);
+                }
+            }
+            for (int i = 1; i < key.count(); ++i) {
+                auto prefixIt = shortcutIndex.prefixes.find(keySequencePrefix(key, i));
+                if (prefixIt == shortcutIndex.prefixes.end()) {
+                    continue;
+                }
+                prefixIt->removeAll(id);
+                if (prefixIt->isEmpty()) {
+                    shortcutIndex.prefixes.erase(prefixIt);
+                }
+            }
+        }
+    }
+
+    void ActionRegistryPrivate::overriddenShortcutsChanged(const QStringList &ids) {
+        markChanged(AE_Keymap, ids);
+
+        // The keymap will be rebuilt on the next query
+        if (extensionsDirty || keymapDirty) {
+            return;
+        }
+        for (const auto &id : ids) {
+            const int index = keymap.indexes.value(id, -1);
+            if (index < 0) {
+                continue;
+            }
+            unindexShortcuts(index);
+            keymap.keys[index] = resolveShortcuts(index);
+            indexShortcuts(index);
+        }
+    }
+
+    void ActionRegistryPrivate::overriddenIconsChanged(const QStringList &ids) {
+        markChanged(AE_Icons, ids);
+    }
+
+    void ActionRegistryPrivate::iconStorageChanged() {
+        markAllChanged(AE_Icons);
+    }
+
+    void ActionRegistryPrivate::markChanged(ActionElement element, const QStringList &ids) {
+        auto &pending = pendingUpdates[element];
+        if (pending.all) {
+            return;
+        }
+        for (const auto &id : ids) {
+            pending.ids.insert(id);
+        }
+    }
+
+    void ActionRegistryPrivate::markAllChanged(ActionElement element) {
+        auto &pending = pendingUpdates[element];
+        pending.all = true;
+        pending.ids.clear();
+    }
+
+    static inline void addUsage(std::atomic<double> &score, double weight) {
+        double old = score.load(std::memory_order_relaxed);
+        while (!score.compare_exchange_weak(old, old + weight, std::memory_order_relaxed)) {
+        }
+    }
+
+    int ActionRegistryPrivate::usageSlot(const QString &id) const {
+        if (auto it = usageIndexes.constFind(id); it != usageIndexes.cend()) {
+            return it.value();
+        }
+        const int slot = int(usageIds.size());
+        usageIds.append(id);
+        usageScores.emplace_back(0.0);
+        usageIndexes.insert(id, slot);
+        return slot;
+    }
+
+    void ActionRegistryPrivate::reserveUsage() const {
+        QWriteLocker locker(&usageLock);
+        for (const auto &pair : std::as_const(actionItems)) {
+            usageSlot(pair.first);
+        }
+    }
+
+    // Returns the factor turning a score into the decayed count at the given time
+    double ActionRegistryPrivate::usageDecay(qint64 now) const {
+        return std::exp2(-double(now - usageEpoch) / double(usageHalfLife));
+    }
+
+    void ActionRegistryPrivate::rebaseUsage(qint64 now) {
+        const double decay = usageDecay(now);
+        for (auto &score : usageScores) {
+            score.store(score.load(std::memory_order_relaxed) * decay, std::memory_order_relaxed);
+        }
+        usageEpoch = now;
+    }
+
+    // Keeps the slots for the next triggers
+    void ActionRegistryPrivate::clearUsage() {
+        for (auto &score : usageScores) {
+            score.store(0, std::memory_order_relaxed);
+        }
+        usageEpoch = QDateTime::currentMSecsSinceEpoch();
     }
 
     ActionCatalog ActionRegistryPrivate::defaultCatalog() const {
@@ -398,6 +615,9 @@ namespace QAK {
             d->extensions.append(ext->id(), ext);
         }
         d->extensionsDirty = true;
+        d->markAllChanged(AE_Texts);
+        d->markAllChanged(AE_Keymap);
+        d->markAllChanged(AE_Icons);
     }
 
     void ActionRegistry::addExtension(const ActionExtension *extension) {
@@ -409,6 +629,9 @@ namespace QAK {
         }
         d->extensions.append(extension->id(), extension);
         d->extensionsDirty = true;
+        d->markAllChanged(AE_Texts);
+        d->markAllChanged(AE_Keymap);
+        d->markAllChanged(AE_Icons);
     }
 
     QStringList ActionRegistry::actionIds() const {
@@ -447,6 +670,332 @@ namespace QAK {
         d->layouts = d->defaultLayouts();
     }
 
+    static bool hasLayoutPath(const QMap<QString, QVector<ActionLayoutEntry>> &adjacencyMap,
+                              const QString &from, const QString &to) {
+        QSet<QString> visited;
+        QVector<QString> stack{from};
+        while (!stack.isEmpty()) {
+            const auto id = stack.takeLast();
+            if (id == to) {
+                return true;
+            }
+            if (visited.contains(id)) {
+                continue;
+            }
+            visited.insert(id);
+            for (const auto &child : adjacencyMap.value(id)) {
+                if (!child.id().isEmpty()) {
+                    stack.append(child.id());
+                }
+            }
+        }
+        return false;
+    }
+
+    void ActionRegistry::patchLayouts(const QMap<QString, QVector<ActionLayoutEntry>> &nodes) {
+        Q_D(ActionRegistry);
+        d->flushActionItems();
+
+        auto adjacencyMap = d->layouts.adjacencyMap();
+        QStringList changedIds;
+        for (auto it = nodes.begin(); it != nodes.end(); ++it) {
+            const auto &id = it.key();
+            if (id.isEmpty()) {
+                continue;
+            }
+
+            QVector<ActionLayoutEntry> children;
+            children.reserve(it.value().size());
+            for (const auto &child : it.value()) {
+                if (LayoutsTrait::childIsSeparator(child)) {
+                    children.append(ActionLayoutEntry({}, child.type()));
+                    continue;
+                }
+                const auto childId = child.id();
+                if (childId.isEmpty()) {
+                    continue;
+                }
+                if (hasLayoutPath(adjacencyMap, childId, id)) {
+                    qCWarning(qActionKitLog).noquote().nospace()
+                        << "Layout entry \"" << childId << "\" of \"" << id
+                        << "\" forms a cycle, skipped";
+                    continue;
+                }
+                if (!adjacencyMap.contains(childId)) {
+                    adjacencyMap.insert(childId, {});
+                }
+                children.append(child);
+            }
+
+            if (auto old = adjacencyMap.constFind(id);
+                old != adjacencyMap.cend() && old.value() == children) {
+                continue;
+            }
+            adjacencyMap.insert(id, children);
+            changedIds.append(id);
+        }
+
+        if (changedIds.isEmpty()) {
+            return;
+        }
+        d->layouts = ActionLayouts(adjacencyMap, d->layouts.hashList());
+        d->markChanged(AE_Layouts, changedIds);
+    }
+
+    QList<QKeySequence> ActionRegistry::actionShortcuts(const QString &id) const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        if (const int index = d->keymap.indexes.value(id, -1); index >= 0) {
+            return d->keymap.keys.at(index);
+        }
+        if (const auto o = shortcuts(id); o) {
+            return o.value();
+        }
+        return {};
+    }
+
+    QJsonArray ActionRegistry::exportKeymap() const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        const auto &keymap = d->keymap;
+        QJsonArray arr;
+        for (int i = 0; i < keymap.ids.size(); ++i) {
+            QJsonArray keysArr;
+            for (const auto &key : keymap.keys.at(i)) {
+                keysArr.push_back(key.toString());
+            }
+            arr.append(QJsonObject({
+                {QStringLiteral("id"),   keymap.ids.at(i)},
+                {QStringLiteral("keys"), keysArr         },
+            }));
+        }
+        return arr;
+    }
+
+    void ActionRegistry::importKeymap(const QJsonArray &arr) {
+        Q_D(ActionRegistry);
+        d->flushKeymap();
+        auto shortcutsFamily = d->overriddenShortcuts;
+        const auto importedFamily = shortcutsFamilyFromJson(arr);
+        for (auto it = importedFamily.begin(); it != importedFamily.end(); ++it) {
+            const auto &id = it.key();
+            const auto &o = it.value();
+            if (!o || (d->keymap.indexes.contains(id) &&
+                       o.value() == d->actionItems.value(id).shortcuts())) {
+                shortcutsFamily.remove(id);
+                continue;
+            }
+            shortcutsFamily.insert(id, o);
+        }
+        // Only the changed entries are patched in the keymap
+        setShortcutsFamily(shortcutsFamily);
+    }
+
+    QStringList ActionRegistry::shortcutActions(const QKeySequence &key) const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        return d->shortcutIndex.keys.value(key);
+    }
+
+    QStringList ActionRegistry::shortcutPrefixActions(const QKeySequence &key) const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        return d->shortcutIndex.prefixes.value(key);
+    }
+
+    bool ActionRegistry::isShortcutConflicting(const QKeySequence &key) const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        return d->shortcutIndex.conflicts.contains(key);
+    }
+
+    bool ActionRegistry::isShortcutAmbiguous(const QKeySequence &key) const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        const auto &index = d->shortcutIndex;
+        if (!index.keys.contains(key)) {
+            return false;
+        }
+        if (index.prefixes.contains(key)) {
+            return true;
+        }
+        for (int i = 1; i < key.count(); ++i) {
+            if (index.keys.contains(keySequencePrefix(key, i))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QList<QKeySequence> ActionRegistry::conflictingShortcuts() const {
+        Q_D(const ActionRegistry);
+        d->flushKeymap();
+        return d->shortcutIndex.conflicts.values();
+    }
+
+    void ActionRegistry::recordUsage(const QString &id) {
+        Q_D(ActionRegistry);
+        const auto now = QDateTime::currentMSecsSinceEpoch();
+        {
+            QReadLocker locker(&d->usageLock);
+            const int slot = d->usageIndexes.value(id, -1);
+            if (slot >= 0 && now - d->usageEpoch <= 64 * d->usageHalfLife) {
+                addUsage(d->usageScores[slot], 1.0 / d->usageDecay(now));
+                return;
+            }
+        }
+
+        // An action not registered yet, or the weights leaving the precision of a double, which
+        // happens once in a long while
+        QWriteLocker locker(&d->usageLock);
+        if (now - d->usageEpoch > 64 * d->usageHalfLife) {
+            d->rebaseUsage(now);
+        }
+        addUsage(d->usageScores[d->usageSlot(id)], 1.0 / d->usageDecay(now));
+    }
+
+    double ActionRegistry::usageScore(const QString &id) const {
+        Q_D(const ActionRegistry);
+        QReadLocker locker(&d->usageLock);
+        const int slot = d->usageIndexes.value(id, -1);
+        if (slot < 0) {
+            return 0;
+        }
+        return d->usageScores[slot].load(std::memory_order_relaxed) *
+               d->usageDecay(QDateTime::currentMSecsSinceEpoch());
+    }
+
+    QHash<QString, double> ActionRegistry::usageScores() const {
+        Q_D(const ActionRegistry);
+        QHash<QString, double> result;
+        QReadLocker locker(&d->usageLock);
+        const double decay = d->usageDecay(QDateTime::currentMSecsSinceEpoch());
+        for (int i = 0; i < d->usageIds.size(); ++i) {
+            if (const double score = d->usageScores[i].load(std::memory_order_relaxed); score > 0) {
+                result.insert(d->usageIds.at(i), score * decay);
+            }
+        }
+        return result;
+    }
+
+    QStringList ActionRegistry::mostUsedActions(int limit) const {
+        Q_D(const ActionRegistry);
+        d->flushActionItems();
+        QReadLocker locker(&d->usageLock);
+        QVector<QPair<double, int>> slots;
+        slots.reserve(d->usageIds.size());
+        for (int i = 0; i < d->usageIds.size(); ++i) {
+            const double score = d->usageScores[i].load(std::memory_order_relaxed);
+            if (score > 0 && d->actionItems.contains(d->usageIds.at(i))) {
+                slots.append({score, i});
+            }
+        }
+        // The scores share the same epoch, so they compare without decaying
+        const auto middle = slots.begin() + qBound(0, limit, int(slots.size()));
+        std::partial_sort(slots.begin(), middle, slots.end(),
+                          [](const QPair<double, int> &a, const QPair<double, int> &b) {
+                              return a.first > b.first || (a.first == b.first && a.second < b.second);
+                          });
+        QStringList result;
+        for (auto it = slots.begin(); it != middle; ++it) {
+            result.append(d->usageIds.at(it->second));
+        }
+        return result;
+    }
+
+    void ActionRegistry::clearUsage() {
+        Q_D(ActionRegistry);
+        QWriteLocker locker(&d->usageLock);
+        d->clearUsage();
+    }
+
+    int ActionRegistry::usageHalfLife() const {
+        Q_D(const ActionRegistry);
+        QReadLocker locker(&d->usageLock);
+        return int(d->usageHalfLife / 1000);
+    }
+
+    void ActionRegistry::setUsageHalfLife(int seconds) {
+        Q_D(ActionRegistry);
+        if (seconds <= 0) {
+            return;
+        }
+        // The scores so far are decayed with the old half life
+        QWriteLocker locker(&d->usageLock);
+        d->rebaseUsage(QDateTime::currentMSecsSinceEpoch());
+        d->usageHalfLife = qint64(seconds) * 1000;
+    }
+
+    static const quint32 UsageMagic = 0x51414B55; // "QAKU"
+    static const quint16 UsageVersion = 1;
+
+    bool ActionRegistry::saveUsage(QIODevice *device) const {
+        Q_D(const ActionRegistry);
+        const auto now = QDateTime::currentMSecsSinceEpoch();
+
+        QVector<QPair<QByteArray, float>> entries;
+        d->flushActionItems();
+        {
+            QReadLocker locker(&d->usageLock);
+            const double decay = d->usageDecay(now);
+            for (int i = 0; i < d->usageIds.size(); ++i) {
+                const auto count = float(d->usageScores[i].load(std::memory_order_relaxed) * decay);
+                if (count > 0 && d->actionItems.contains(d->usageIds.at(i))) {
+                    entries.append({d->usageIds.at(i).toUtf8(), count});
+                }
+            }
+        }
+
+        // Magic, version, time of the counts, then the UTF-8 ids with their decayed counts
+        QDataStream out(device);
+        out.setVersion(QDataStream::Qt_6_0);
+        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        out << UsageMagic << UsageVersion << qint64(now) << quint32(entries.size());
+        for (const auto &entry : std::as_const(entries)) {
+            out << entry.first << entry.second;
+        }
+        return out.status() == QDataStream::Ok;
+    }
+
+    bool ActionRegistry::loadUsage(QIODevice *device) {
+        Q_D(ActionRegistry);
+        QDataStream in(device);
+        in.setVersion(QDataStream::Qt_6_0);
+        in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+        quint32 magic;
+        quint16 version;
+        qint64 savedAt;
+        quint32 count;
+        in >> magic >> version >> savedAt >> count;
+        if (in.status() != QDataStream::Ok || magic != UsageMagic || version != UsageVersion) {
+            qCWarning(qActionKitLog) << "Invalid action usage data";
+            return false;
+        }
+
+        QVector<QPair<QString, float>> entries;
+        for (quint32 i = 0; i < count; ++i) {
+            QByteArray id;
+            float value;
+            in >> id >> value;
+            if (in.status() != QDataStream::Ok) {
+                qCWarning(qActionKitLog) << "Truncated action usage data";
+                return false;
+            }
+            entries.append({QString::fromUtf8(id), value});
+        }
+
+        QWriteLocker locker(&d->usageLock);
+        d->clearUsage();
+        // The counts were decayed up to the time they were saved
+        const double weight = 1.0 / d->usageDecay(savedAt);
+        for (const auto &entry : std::as_const(entries)) {
+            d->usageScores[d->usageSlot(entry.first)].store(entry.second * weight,
+                                                             std::memory_order_relaxed);
+        }
+        return true;
+    }
+
     ActionRegistry::ActionRegistry(ActionRegistryPrivate &d, QObject *parent)
         : ActionFamily(d, parent) {
     }
@@ -462,6 +1011,7 @@ namespace QAK {
             reg->removeContext(ctx);
         }
         reg = this;
+        ctx->d_func()->registryChanged();
     }
 
     void ActionRegistry::removeContext(ActionContext *ctx) {
@@ -472,10 +1022,16 @@ namespace QAK {
             }
         }
         ctx->d_func()->registry = nullptr;
+        ctx->d_func()->registryChanged();
     }
 
     void ActionRegistry::updateContext(ActionElement element) {
         Q_D(ActionRegistry);
+        const auto pending = std::exchange(d->pendingUpdates[element], {});
+        if (!pending.all && !pending.ids.isEmpty()) {
+            updateContext(element, pending.ids.values());
+            return;
+        }
         for (auto &ctx : d->contexts) {
             if (ctx) {
                 ctx->updateElement(element);
@@ -483,4 +1039,13 @@ namespace QAK {
         }
     }
 
+    void ActionRegistry::updateContext(ActionElement element, const QStringList &ids) {
+        Q_D(ActionRegistry);
+        for (auto &ctx : d->contexts) {
+            if (ctx) {
+                ctx->updateActions(element, ids);
+            }
+        }
+    }
+
 }
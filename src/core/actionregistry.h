@@ -1,6 +1,8 @@
 #ifndef ACTIONREGISTRY_H
 #define ACTIONREGISTRY_H
 
+#include <QtCore/QHash>
+#include <QtCore/QIODevice>
 #include <QtCore/QMap>
 #include <QtCore/QSharedData>
 
@@ -75,6 +77,9 @@ namespace QAK {
         inline QStringList hashList() const {
             return m_hashList;
         }
+        /// Returns the children of \a id with the groups expanded in place and delimited by
+        /// separators, the leading, trailing and adjacent separators are collapsed.
+        QAK_CORE_EXPORT QVector<ActionLayoutEntry> flattenedChildren(const QString &id) const;
         QAK_CORE_EXPORT QJsonObject toJsonObject() const;
         QAK_CORE_EXPORT static ActionLayouts fromJsonObject(const QJsonObject &obj);
 
@@ -106,28 +111,84 @@ namespace QAK {
         ActionLayouts layouts() const;
         void setLayouts(const ActionLayouts &layouts);
         void resetLayouts();
+        /// Replaces the children of the given nodes and keeps the rest of the layouts. Only the
+        /// patched children are checked for cycles, and the next layouts update only targets the
+        /// nodes that have actually changed.
+        void patchLayouts(const QMap<QString, QVector<ActionLayoutEntry>> &nodes);
+
+        /// Returns the resolved shortcuts of the given action, i.e. the overridden shortcuts if
+        /// present, otherwise the default shortcuts declared by the extensions.
+        QList<QKeySequence> actionShortcuts(const QString &id) const;
+
+        /// Exports the resolved shortcuts of all actions in the format of
+        /// \c ActionFamily::shortcutsFamilyToJson.
+        QJsonArray exportKeymap() const;
+        /// Imports a keymap in the format of \c ActionFamily::shortcutsFamilyToJson. The keymap
+        /// is merged into the current overrides: the actions absent from \a arr keep their
+        /// shortcuts, the entries equal to the defaults or set to null drop their overrides.
+        /// Call \c resetShortcuts() first to replace the overrides, a keymap exported by
+        /// \c exportKeymap() lists every action and replaces them anyway.
+        void importKeymap(const QJsonArray &arr);
 
-        inline QList<QKeySequence> actionShortcuts(const QString &id) const;
+    public:
+        /// This set of functions queries the reverse shortcut index, which maps each key sequence
+        /// bound by the extension defaults or the overridden shortcuts to the action ids.
+
+        /// Returns the ids of the actions bound to the given key sequence.
+        QStringList shortcutActions(const QKeySequence &key) const;
+        /// Returns the ids of the actions bound to a longer key sequence starting with the given
+        /// chord.
+        QStringList shortcutPrefixActions(const QKeySequence &key) const;
+        /// Returns whether the given key sequence is bound to more than one action.
+        bool isShortcutConflicting(const QKeySequence &key) const;
+        /// Returns whether the given key sequence is bound and, at the same time, is a chord prefix
+        /// of another binding or has a bound chord prefix.
+        bool isShortcutAmbiguous(const QKeySequence &key) const;
+        /// Returns all key sequences that are bound to more than one action.
+        QList<QKeySequence> conflictingShortcuts() const;
+
+    public:
+        /// This set of functions records how often the actions are triggered. Each trigger counts
+        /// as 1 and decays exponentially with the half life, so that the recent usage dominates.
+
+        /// Records a trigger of the given action, the cost does not depend on the number of
+        /// actions. The triggers, the scores and the half life may be recorded and read from any
+        /// thread.
+        Q_INVOKABLE void recordUsage(const QString &id);
+        /// Returns the decayed trigger count of the given action.
+        Q_INVOKABLE double usageScore(const QString &id) const;
+        /// Returns the decayed trigger counts of all used actions at once, cheaper than calling
+        /// \c usageScore() for many actions.
+        QHash<QString, double> usageScores() const;
+        /// Returns the ids of the most used registered actions, most used first.
+        Q_INVOKABLE QStringList mostUsedActions(int limit) const;
+        void clearUsage();
+
+        /// Returns the half life of the usage in seconds, 7 days by default.
+        int usageHalfLife() const;
+        void setUsageHalfLife(int seconds);
+
+        /// Writes the usage of the registered actions in a compact binary format.
+        bool saveUsage(QIODevice *device) const;
+        /// Replaces the usage with the one read from \a device.
+        bool loadUsage(QIODevice *device);
 
     public:
         /// Registers a context with the registry.
         void addContext(ActionContext *ctx);
         /// Unregisters a context from the registry.
         void removeContext(ActionContext *ctx);
-        /// Updates the context of all contexts that are registered with the registry.
+        /// Updates the context of all contexts that are registered with the registry. When only
+        /// the overridden shortcuts or icons of some actions have changed since the last update of
+        /// \a element, only these actions are updated.
         void updateContext(ActionElement element);
+        /// Updates the given actions of all contexts that are registered with the registry.
+        void updateContext(ActionElement element, const QStringList &ids);
 
     protected:
         explicit ActionRegistry(ActionRegistryPrivate &d, QObject *parent = nullptr);
     };
 
-    inline QList<QKeySequence> ActionRegistry::actionShortcuts(const QString &id) const {
-        if (const auto o = shortcuts(id); o) {
-            return o.value();
-        }
-        return actionInfo(id).shortcuts();
-    }
-
 }
 
 #endif // ACTIONREGISTRY_H
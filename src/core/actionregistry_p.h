@@ -10,7 +10,13 @@
 // version without notice, or may even be removed.
 //
 
+#include <atomic>
+#include <deque>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QPointer>
+#include <QtCore/QSet>
 #include <QtCore/QVarLengthArray>
 
 #include <stdcorelib/linked_map.h>
@@ -37,8 +43,59 @@ namespace QAK {
 
         QVector<QPointer<ActionContext>> contexts;
 
+        // Shortcuts
+        struct Keymap {
+            QVector<QString> ids;              // index -> id
+            QHash<QString, int> indexes;       // id -> index
+            QVector<QList<QKeySequence>> keys; // index -> resolved keys
+        };
+        struct ShortcutIndex {
+            QHash<QKeySequence, QStringList> keys;     // key -> [id]
+            QHash<QKeySequence, QStringList> prefixes; // chord prefix -> [id]
+            QSet<QKeySequence> conflicts;
+        };
+        mutable Keymap keymap;
+        mutable ShortcutIndex shortcutIndex;
+        mutable bool keymapDirty = true;
+
         void flushActionItems() const;
 
+        void flushKeymap() const;
+        QList<QKeySequence> resolveShortcuts(int index) const;
+        void indexShortcuts(int index) const;
+        void unindexShortcuts(int index) const;
+        void overriddenShortcutsChanged(const QStringList &ids) override;
+
+        // Ids changed since the last update of each element, all means an untargeted change
+        struct PendingUpdate {
+            QSet<QString> ids;
+            bool all = false;
+        };
+        PendingUpdate pendingUpdates[AE_Icons + 1];
+
+        void overriddenIconsChanged(const QStringList &ids) override;
+        void iconStorageChanged() override;
+        void markChanged(ActionElement element, const QStringList &ids);
+        void markAllChanged(ActionElement element);
+
+        // Usage, each trigger adds 2^((t - usageEpoch) / half life) to the score of the action,
+        // so that an increment never touches the other actions and all the scores compare
+        // as they are. The slots of the registered actions are created when the extensions are
+        // flushed, a trigger then only takes the read lock and adds to its slot atomically. The
+        // slots are created and the epoch is changed under the write lock.
+        mutable QReadWriteLock usageLock;
+        mutable QHash<QString, int> usageIndexes;             // id -> slot
+        mutable QVector<QString> usageIds;                    // slot -> id
+        mutable std::deque<std::atomic<double>> usageScores; // keeps its elements in place
+        qint64 usageEpoch = QDateTime::currentMSecsSinceEpoch();
+        qint64 usageHalfLife = qint64(7) * 24 * 3600 * 1000; // ms
+
+        int usageSlot(const QString &id) const;
+        void reserveUsage() const;
+        double usageDecay(qint64 now) const;
+        void rebaseUsage(qint64 now);
+        void clearUsage();
+
         ActionCatalog defaultCatalog() const;
         ActionLayouts defaultLayouts() const;
 
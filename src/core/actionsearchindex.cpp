@@ -0,0 +1,360 @@
+#include "actionsearchindex.h"
+#include "actionsearchindex_p.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <string>
+
+#include "actionregistry.h"
+
+namespace QAK {
+
+    static inline quint64 charBit(char16_t c) {
+        if (c >= u'a' && c <= u'z')
+            return quint64(1) << (c - u'a');
+        if (c >= u'0' && c <= u'9')
+            return quint64(1) << (26 + c - u'0');
+        return quint64(1) << (36 + c % 28);
+    }
+
+    static inline quint64 trigramOf(const char16_t *p) {
+        return (quint64(p[0]) << 32) | (quint64(p[1]) << 16) | quint64(p[2]);
+    }
+
+    static inline bool isWordStart(const char16_t *s, int i) {
+        if (i == 0)
+            return true;
+        const QChar prev(s[i - 1]);
+        return !prev.isLetterOrNumber();
+    }
+
+    // Drops the mnemonic markers of a menu text, "&&" stands for a literal ampersand
+    static QString plainText(const QString &text) {
+        QString result;
+        result.reserve(text.size());
+        for (int i = 0; i < text.size(); ++i) {
+            if (text.at(i) == QLatin1Char('&') && i + 1 < text.size())
+                ++i;
+            result.append(text.at(i));
+        }
+        return result;
+    }
+
+    // Returns the score of needle in hay, or -1 if needle is not a subsequence of hay. The
+    // substring matches are flagged as contiguous, the other matches score below 1000.
+    static int matchField(const char16_t *hay, int n, const char16_t *needle, int m,
+                          bool *contiguous) {
+        if (m == 0 || m > n)
+            return -1;
+
+        int best = -1;
+        for (int i = 0; i + m <= n; ++i) {
+            if (hay[i] != needle[0] ||
+                std::char_traits<char16_t>::compare(hay + i + 1, needle + 1, m - 1) != 0)
+                continue;
+            int score = 1000 + 10 * m - std::min(i, 50);
+            if (m == n) {
+                score += 300;
+            } else if (i == 0) {
+                score += 200;
+            } else if (isWordStart(hay, i)) {
+                score += 100;
+            }
+            best = std::max(best, score);
+            if (i == 0)
+                break;
+        }
+        if (best >= 0) {
+            *contiguous = true;
+            return best;
+        }
+
+        int score = 0;
+        int j = 0;
+        int last = -1;
+        for (int i = 0; i < n && j < m; ++i) {
+            if (hay[i] != needle[j])
+                continue;
+            score += 1;
+            if (isWordStart(hay, i))
+                score += 8;
+            if (last >= 0) {
+                if (last == i - 1) {
+                    score += 5;
+                } else {
+                    score -= std::min(i - last - 1, 3);
+                }
+            }
+            last = i;
+            ++j;
+        }
+        if (j < m)
+            return -1;
+        *contiguous = false;
+        return std::clamp(score, 1, 999);
+    }
+
+    ActionSearchIndexPrivate::ActionSearchIndexPrivate() = default;
+
+    ActionSearchIndexPrivate::~ActionSearchIndexPrivate() = default;
+
+    void ActionSearchIndexPrivate::flush() const {
+        if (indexedRegistry != registry) {
+            indexedRegistry = registry;
+            dirty = true;
+        }
+        // Compact when most of the entries have been replaced
+        if (deadCount > 64 && deadCount > entries.size() / 2)
+            dirty = true;
+        if (!dirty)
+            return;
+        dirty = false;
+        rebuild();
+    }
+
+    void ActionSearchIndexPrivate::rebuild() const {
+        buffer.clear();
+        entries.clear();
+        indexes.clear();
+        trigrams.clear();
+        deadCount = 0;
+        if (!registry)
+            return;
+        const auto ids = registry->actionIds();
+        entries.reserve(ids.size());
+        buffer.reserve(ids.size() * 48);
+        for (const auto &id : ids) {
+            addEntry(id);
+        }
+    }
+
+    void ActionSearchIndexPrivate::addEntry(const QString &id) const {
+        removeEntry(id);
+        const auto info = registry->actionInfo(id);
+        if (info.isNull() || info.type() != ActionItemInfo::Action)
+            return;
+
+        const int index = int(entries.size());
+        Entry entry;
+        entry.id = id;
+        entry.mask = 0;
+        entry.alive = true;
+
+        const QString fields[FieldCount] = {
+            plainText(info.text(true)).toCaseFolded(),
+            info.actionClass(true).toCaseFolded(),
+            info.description(true).toCaseFolded(),
+            id.toCaseFolded(),
+        };
+        QVector<quint64> entryTrigrams;
+        for (int f = 0; f < FieldCount; ++f) {
+            entry.offsets[f] = int(buffer.size());
+            const auto &field = fields[f];
+            const auto data = reinterpret_cast<const char16_t *>(field.constData());
+            const int n = int(field.size());
+            buffer.resize(entry.offsets[f] + n);
+            std::copy_n(data, n, buffer.data() + entry.offsets[f]);
+            for (int i = 0; i < n; ++i) {
+                entry.mask |= charBit(data[i]);
+            }
+            for (int i = 0; i + 3 <= n; ++i) {
+                entryTrigrams.append(trigramOf(data + i));
+            }
+        }
+        entry.offsets[FieldCount] = int(buffer.size());
+
+        std::sort(entryTrigrams.begin(), entryTrigrams.end());
+        entryTrigrams.erase(std::unique(entryTrigrams.begin(), entryTrigrams.end()),
+                            entryTrigrams.end());
+        for (const auto trigram : std::as_const(entryTrigrams)) {
+            // The entries are only appended, the postings stay sorted
+            trigrams[trigram].append(index);
+        }
+
+        entries.append(entry);
+        indexes.insert(id, index);
+    }
+
+    void ActionSearchIndexPrivate::removeEntry(const QString &id) const {
+        auto it = indexes.find(id);
+        if (it == indexes.end())
+            return;
+        const int index = it.value();
+        indexes.erase(it);
+        // The postings keep the index, the dead entries are skipped by the queries
+        entries[index].alive = false;
+        deadCount++;
+    }
+
+    ActionSearchIndex::ActionSearchIndex(QObject *parent)
+        : ActionContext(*new ActionSearchIndexPrivate(), parent) {
+    }
+
+    ActionSearchIndex::~ActionSearchIndex() = default;
+
+    int ActionSearchIndex::size() const {
+        Q_D(const ActionSearchIndex);
+        d->flush();
+        return int(d->indexes.size());
+    }
+
+    QList<ActionSearchIndex::Result> ActionSearchIndex::search(const QString &query,
+                                                               int limit) const {
+        Q_D(const ActionSearchIndex);
+        if (limit <= 0)
+            return {};
+        d->flush();
+
+        const auto terms = query.toCaseFolded().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        if (terms.isEmpty())
+            return {};
+
+        quint64 queryMask = 0;
+        QVector<quint64> queryTrigrams;
+        for (const auto &term : terms) {
+            const auto data = reinterpret_cast<const char16_t *>(term.constData());
+            for (int i = 0; i < term.size(); ++i) {
+                queryMask |= charBit(data[i]);
+            }
+            for (int i = 0; i + 3 <= term.size(); ++i) {
+                queryTrigrams.append(trigramOf(data + i));
+            }
+        }
+
+        struct Candidate {
+            bool contiguous;
+            int score;
+            int index;
+
+            // Whether this candidate ranks before the other one
+            bool operator<(const Candidate &other) const {
+                if (contiguous != other.contiguous)
+                    return contiguous;
+                if (score != other.score)
+                    return score > other.score;
+                return index < other.index;
+            }
+        };
+        // The worst of the best candidates on top
+        std::priority_queue<Candidate> top;
+        int contiguousCount = 0;
+
+        const auto &entries = d->entries;
+        const auto buffer = d->buffer.constData();
+        // Read once per query rather than once per candidate
+        const auto usage = d->registry ? d->registry->usageScores() : QHash<QString, double>();
+        const auto score = [&](int index) {
+            const auto &entry = entries.at(index);
+            if (!entry.alive || (entry.mask & queryMask) != queryMask)
+                return;
+
+            static const int weights[ActionSearchIndexPrivate::FieldCount] = {4, 2, 1, 2};
+            Candidate candidate{true, 0, index};
+            for (const auto &term : terms) {
+                const auto needle = reinterpret_cast<const char16_t *>(term.constData());
+                bool termContiguous = false;
+                int termScore = -1;
+                for (int f = 0; f < ActionSearchIndexPrivate::FieldCount; ++f) {
+                    const int begin = entry.offsets[f];
+                    bool contiguous = false;
+                    int s = matchField(buffer + begin, entry.offsets[f + 1] - begin, needle,
+                                       int(term.size()), &contiguous);
+                    if (s < 0)
+                        continue;
+                    s *= weights[f];
+                    if ((contiguous && !termContiguous) ||
+                        (contiguous == termContiguous && s > termScore)) {
+                        termContiguous = contiguous;
+                        termScore = s;
+                    }
+                }
+                if (termScore < 0)
+                    return;
+                candidate.contiguous = candidate.contiguous && termContiguous;
+                candidate.score += termScore;
+            }
+
+            // The frequently used actions rank higher among the matches of the same kind
+            if (const double count = usage.value(entry.id); count > 0)
+                candidate.score += int(64 * std::log2(1 + count));
+
+            if (candidate.contiguous)
+                contiguousCount++;
+            top.push(candidate);
+            if (int(top.size()) > limit)
+                top.pop();
+        };
+
+        bool done = false;
+        if (!queryTrigrams.isEmpty()) {
+            // An action matching every term as a substring has all trigrams of the query, and
+            // such actions rank before the others. When there are enough of them among the
+            // candidates of the trigrams, the other actions cannot make it into the results.
+            std::sort(queryTrigrams.begin(), queryTrigrams.end());
+            queryTrigrams.erase(std::unique(queryTrigrams.begin(), queryTrigrams.end()),
+                                queryTrigrams.end());
+            QVector<const QVector<int> *> postings;
+            for (const auto trigram : std::as_const(queryTrigrams)) {
+                auto it = d->trigrams.constFind(trigram);
+                if (it == d->trigrams.cend()) {
+                    postings.clear();
+                    break;
+                }
+                postings.append(&it.value());
+            }
+            if (!postings.isEmpty()) {
+                std::sort(postings.begin(), postings.end(),
+                          [](const QVector<int> *a, const QVector<int> *b) {
+                              return a->size() < b->size();
+                          });
+                QVector<int> candidates = *postings.front();
+                QVector<int> intersection;
+                for (int i = 1; i < postings.size() && !candidates.isEmpty(); ++i) {
+                    intersection.clear();
+                    std::set_intersection(candidates.cbegin(), candidates.cend(),
+                                          postings.at(i)->cbegin(), postings.at(i)->cend(),
+                                          std::back_inserter(intersection));
+                    candidates.swap(intersection);
+                }
+                for (const int index : std::as_const(candidates)) {
+                    score(index);
+                }
+            }
+            done = contiguousCount >= limit;
+        }
+        if (!done) {
+            top = {};
+            for (int i = 0; i < entries.size(); ++i) {
+                score(i);
+            }
+        }
+
+        QList<Result> result(int(top.size()));
+        for (auto i = result.size() - 1; i >= 0; --i) {
+            const auto &candidate = top.top();
+            result[i] = {entries.at(candidate.index).id, candidate.score};
+            top.pop();
+        }
+        return result;
+    }
+
+    void ActionSearchIndex::updateElement(ActionElement element) {
+        Q_D(ActionSearchIndex);
+        if (element != AE_Texts)
+            return;
+        d->dirty = true;
+    }
+
+    void ActionSearchIndex::updateActions(ActionElement element, const QStringList &ids) {
+        Q_D(ActionSearchIndex);
+        if (element != AE_Texts)
+            return;
+        if (d->dirty || d->indexedRegistry != d->registry || !d->registry)
+            return;
+        for (const auto &id : ids) {
+            d->addEntry(id);
+        }
+    }
+
+}
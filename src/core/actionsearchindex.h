@@ -0,0 +1,45 @@
+#ifndef ACTIONSEARCHINDEX_H
+#define ACTIONSEARCHINDEX_H
+
+#include <QAKCore/actioncontext.h>
+
+namespace QAK {
+
+    class ActionSearchIndexPrivate;
+
+    /// \class ActionSearchIndex
+    /// \brief ActionSearchIndex answers the fuzzy queries of a command palette over the actions
+    /// of a registry. The translated text, class, description and id of each action are folded
+    /// once into a flat buffer, so that a query never translates or allocates per action.
+    ///
+    /// The index is added to a registry like any other context, a text update of some actions
+    /// only re-indexes these actions while a full text update, e.g. after the extensions or the
+    /// language have changed, rebuilds the index on the next query.
+    class QAK_CORE_EXPORT ActionSearchIndex : public ActionContext {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(ActionSearchIndex)
+    public:
+        explicit ActionSearchIndex(QObject *parent = nullptr);
+        ~ActionSearchIndex() override;
+
+        struct Result {
+            QString id;
+            int score;
+        };
+
+        /// Returns the number of indexed actions.
+        int size() const;
+
+        /// Returns the \a limit best matches of \a query, best first. The query is split at
+        /// white spaces and every term must match one of the fields as a subsequence, the
+        /// actions matching all terms as substrings rank first. The usage recorded by the
+        /// registry raises the score of the frequently used actions.
+        QList<Result> search(const QString &query, int limit = 20) const;
+
+        void updateElement(ActionElement element) override;
+        void updateActions(ActionElement element, const QStringList &ids) override;
+    };
+
+}
+
+#endif // ACTIONSEARCHINDEX_H
@@ -0,0 +1,61 @@
+#ifndef ACTIONSEARCHINDEX_P_H
+#define ACTIONSEARCHINDEX_P_H
+
+//
+//  W A R N I N G !!!
+//  -----------------
+//
+// This file is not part of the QActionKit API. It is used purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or may even be removed.
+//
+
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+
+#include <QAKCore/actionsearchindex.h>
+#include <QAKCore/private/actioncontext_p.h>
+
+namespace QAK {
+
+    class ActionSearchIndexPrivate : public ActionContextPrivate {
+        Q_DECLARE_PUBLIC(ActionSearchIndex)
+    public:
+        ActionSearchIndexPrivate();
+        ~ActionSearchIndexPrivate();
+
+        enum Field {
+            Text,
+            Class,
+            Description,
+            Id,
+            FieldCount,
+        };
+
+        struct Entry {
+            QString id;
+            int offsets[FieldCount + 1]; // field -> begin in the buffer, the last is the end
+            quint64 mask;                // the characters present, see charBit()
+            bool alive;
+        };
+
+        // All fields of all entries, case folded and back to back
+        mutable QVector<char16_t> buffer;
+        mutable QVector<Entry> entries;
+        mutable QHash<QString, int> indexes;            // id -> live entry
+        mutable QHash<quint64, QVector<int>> trigrams; // trigram -> ascending entries
+        mutable int deadCount = 0;
+
+        mutable QPointer<ActionRegistry> indexedRegistry;
+        mutable bool dirty = true;
+
+        void flush() const;
+        void rebuild() const;
+        void addEntry(const QString &id) const;
+        void removeEntry(const QString &id) const;
+    };
+
+}
+
+#endif // ACTIONSEARCHINDEX_P_H
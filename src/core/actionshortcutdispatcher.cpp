@@ -0,0 +1,474 @@
+#include "actionshortcutdispatcher.h"
+#include "actionshortcutdispatcher_p.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtGui/QKeyEvent>
+
+#include "actionregistry.h"
+
+namespace QAK {
+
+    static inline bool isModifierKey(int key) {
+        switch (key) {
+            case Qt::Key_Shift:
+            case Qt::Key_Control:
+            case Qt::Key_Meta:
+            case Qt::Key_Alt:
+            case Qt::Key_AltGr:
+            case Qt::Key_CapsLock:
+            case Qt::Key_NumLock:
+            case Qt::Key_unknown:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static inline int chordOf(QKeyCombination key) {
+        // The keypad keys trigger the same bindings as the main ones
+        return QKeyCombination(key.keyboardModifiers() & ~Qt::KeypadModifier, key.key()).toCombined();
+    }
+
+    static QKeySequence sequenceOf(const QVector<int> &chords) {
+        int keys[4] = {};
+        for (int i = 0; i < chords.size() && i < 4; ++i) {
+            keys[i] = chords.at(i);
+        }
+        return QKeySequence(keys[0], keys[1], keys[2], keys[3]);
+    }
+
+    static QKeySequence normalizedOf(const QKeySequence &key) {
+        QVector<int> chords;
+        for (int i = 0; i < key.count(); ++i) {
+            chords.append(chordOf(key[i]));
+        }
+        return sequenceOf(chords);
+    }
+
+    ActionShortcutDispatcherPrivate::ActionShortcutDispatcherPrivate() : nodes(1) {
+    }
+
+    ActionShortcutDispatcherPrivate::~ActionShortcutDispatcherPrivate() = default;
+
+    void ActionShortcutDispatcherPrivate::flushTrie() {
+        if (compiledRegistry != registry) {
+            compiledRegistry = registry;
+            trieDirty = true;
+        }
+        if (!trieDirty)
+            return;
+        trieDirty = false;
+
+        resetPending();
+        nodes = QVector<Node>(1);
+        boundKeys.clear();
+        if (!registry)
+            return;
+        const auto ids = registry->actionIds();
+        for (const auto &id : ids) {
+            bind(id, registry->actionShortcuts(id));
+        }
+    }
+
+    void ActionShortcutDispatcherPrivate::bind(const QString &id, const QList<QKeySequence> &keys) {
+        const auto scope = actionScopes.value(id);
+        QList<QKeySequence> bound;
+        for (const auto &sequence : keys) {
+            // Bound like the key events are looked up, see processKey()
+            const auto key = normalizedOf(sequence);
+            if (key.isEmpty() || bound.contains(key))
+                continue;
+            bound.append(key);
+
+            int node = 0;
+            for (int i = 0; i < key.count(); ++i) {
+                nodes[node].below[scope]++;
+                const int chord = chordOf(key[i]);
+                int child = nodes[node].children.value(chord, -1);
+                if (child < 0) {
+                    child = int(nodes.size());
+                    nodes[node].children.insert(chord, child);
+                    nodes.append(Node());
+                }
+                node = child;
+            }
+            nodes[node].ids.append(id);
+        }
+        if (!bound.isEmpty())
+            boundKeys.insert(id, bound);
+    }
+
+    void ActionShortcutDispatcherPrivate::unbind(const QString &id) {
+        const auto keys = boundKeys.take(id);
+        if (keys.isEmpty())
+            return;
+        // The nodes are left in place, a node without bindings is skipped by the lookups
+        const auto scope = actionScopes.value(id);
+        for (const auto &key : keys) {
+            int node = 0;
+            for (int i = 0; i < key.count() && node >= 0; ++i) {
+                auto &below = nodes[node].below;
+                if (auto it = below.find(scope); it != below.end() && --it.value() == 0)
+                    below.erase(it);
+                node = nodes[node].children.value(chordOf(key[i]), -1);
+            }
+            if (node >= 0)
+                nodes[node].ids.removeOne(id);
+        }
+    }
+
+    void ActionShortcutDispatcherPrivate::rebind(const QStringList &ids) {
+        if (trieDirty || compiledRegistry != registry || !registry)
+            return;
+        resetPending();
+        for (const auto &id : ids) {
+            unbind(id);
+            bind(id, registry->actionShortcuts(id));
+        }
+    }
+
+    QStringList ActionShortcutDispatcherPrivate::effectiveScopes(const QObject *receiver) const {
+        QStringList result;
+        for (auto o = receiver; o; o = o->parent()) {
+            if (const auto scope = objectScopes.value(o); !scope.isEmpty() && !result.contains(scope))
+                result.append(scope);
+        }
+        for (const auto &scope : activeScopes) {
+            if (!result.contains(scope))
+                result.append(scope);
+        }
+        result.append(QString()); // the unscoped actions come last
+        return result;
+    }
+
+    bool ActionShortcutDispatcherPrivate::hasOwn(const Node &node, const QStringList &scopes) const {
+        for (const auto &id : node.ids) {
+            if (scopes.contains(actionScopes.value(id)))
+                return true;
+        }
+        return false;
+    }
+
+    bool ActionShortcutDispatcherPrivate::hasBelow(const Node &node, const QStringList &scopes) const {
+        for (const auto &scope : scopes) {
+            if (node.below.value(scope) > 0)
+                return true;
+        }
+        return false;
+    }
+
+    int ActionShortcutDispatcherPrivate::nextNode(int node, int chord, const QStringList &scopes) const {
+        const int child = nodes.at(node).children.value(chord, -1);
+        if (child < 0)
+            return -1;
+        const auto &n = nodes.at(child);
+        if (!hasOwn(n, scopes) && !hasBelow(n, scopes))
+            return -1;
+        return child;
+    }
+
+    bool ActionShortcutDispatcherPrivate::wouldConsume(QKeyCombination key, const QObject *receiver) {
+        if (isModifierKey(key.key()))
+            return false;
+        flushTrie();
+        if (pendingNode > 0)
+            return true;
+        return nextNode(0, chordOf(key), effectiveScopes(receiver)) >= 0;
+    }
+
+    void ActionShortcutDispatcherPrivate::setPending(int node, const QVector<int> &chords,
+                                                     const QStringList &scopes) {
+        Q_Q(ActionShortcutDispatcher);
+        pendingNode = node;
+        pendingChords = chords;
+        pendingScopes = scopes;
+        if (chordTimeout >= 0)
+            chordTimer->start(chordTimeout);
+        emit q->pendingChanged();
+    }
+
+    void ActionShortcutDispatcherPrivate::resetPending() {
+        Q_Q(ActionShortcutDispatcher);
+        if (pendingNode == 0)
+            return;
+        pendingNode = 0;
+        pendingChords.clear();
+        pendingScopes.clear();
+        chordTimer->stop();
+        emit q->pendingChanged();
+    }
+
+    void ActionShortcutDispatcherPrivate::trigger(int node, const QVector<int> &chords,
+                                                  const QStringList &scopes) {
+        Q_Q(ActionShortcutDispatcher);
+        const auto &ids = nodes.at(node).ids;
+        for (const auto &scope : scopes) {
+            QStringList candidates;
+            for (const auto &id : ids) {
+                if (actionScopes.value(id) == scope)
+                    candidates.append(id);
+            }
+            if (candidates.isEmpty())
+                continue;
+            if (candidates.size() == 1) {
+                if (registry)
+                    registry->recordUsage(candidates.front());
+                emit q->actionTriggered(candidates.front());
+            } else {
+                emit q->actionAmbiguous(sequenceOf(chords), candidates);
+            }
+            return;
+        }
+    }
+
+    void ActionShortcutDispatcherPrivate::chordTimedOut() {
+        if (pendingNode == 0)
+            return;
+        // The sequence pressed so far is complete when no further chord comes in time
+        const int node = pendingNode;
+        const auto chords = pendingChords;
+        const auto scopes = pendingScopes;
+        resetPending();
+        trigger(node, chords, scopes);
+    }
+
+    ActionShortcutDispatcher::ActionShortcutDispatcher(QObject *parent)
+        : ActionContext(*new ActionShortcutDispatcherPrivate(), parent) {
+        Q_D(ActionShortcutDispatcher);
+        d->chordTimer = new QTimer(this);
+        d->chordTimer->setSingleShot(true);
+        connect(d->chordTimer, &QTimer::timeout, this, [d] { d->chordTimedOut(); });
+    }
+
+    ActionShortcutDispatcher::~ActionShortcutDispatcher() = default;
+
+    int ActionShortcutDispatcher::chordTimeout() const {
+        Q_D(const ActionShortcutDispatcher);
+        return d->chordTimeout;
+    }
+
+    void ActionShortcutDispatcher::setChordTimeout(int timeout) {
+        Q_D(ActionShortcutDispatcher);
+        d->chordTimeout = timeout;
+        if (d->pendingNode > 0) {
+            if (timeout >= 0) {
+                d->chordTimer->start(timeout);
+            } else {
+                d->chordTimer->stop();
+            }
+        }
+    }
+
+    QStringList ActionShortcutDispatcher::scopeActions(const QString &scope) const {
+        Q_D(const ActionShortcutDispatcher);
+        return d->scopes.value(scope);
+    }
+
+    void ActionShortcutDispatcher::setScopeActions(const QString &scope, const QStringList &ids) {
+        Q_D(ActionShortcutDispatcher);
+        if (scope.isEmpty())
+            return;
+
+        // The trie counts the bindings per scope, so the moved actions are bound again
+        QStringList changed = d->scopes.value(scope);
+        for (const auto &id : ids) {
+            if (!changed.contains(id))
+                changed.append(id);
+        }
+        const bool patch = !d->trieDirty && d->compiledRegistry == d->registry;
+        if (patch) {
+            d->resetPending();
+            for (const auto &id : std::as_const(changed)) {
+                d->unbind(id);
+            }
+        }
+
+        for (const auto &id : d->scopes.value(scope)) {
+            d->actionScopes.remove(id);
+        }
+        for (const auto &id : ids) {
+            // An action belongs to one scope only
+            if (const auto old = d->actionScopes.value(id); !old.isEmpty() && old != scope)
+                d->scopes[old].removeAll(id);
+            d->actionScopes.insert(id, scope);
+        }
+        if (ids.isEmpty()) {
+            d->scopes.remove(scope);
+        } else {
+            d->scopes.insert(scope, ids);
+        }
+
+        if (patch && d->registry) {
+            for (const auto &id : std::as_const(changed)) {
+                d->bind(id, d->registry->actionShortcuts(id));
+            }
+        }
+    }
+
+    void ActionShortcutDispatcher::removeScope(const QString &scope) {
+        setScopeActions(scope, {});
+    }
+
+    QStringList ActionShortcutDispatcher::activeScopes() const {
+        Q_D(const ActionShortcutDispatcher);
+        return d->activeScopes;
+    }
+
+    void ActionShortcutDispatcher::setActiveScopes(const QStringList &scopes) {
+        Q_D(ActionShortcutDispatcher);
+        d->activeScopes = scopes;
+    }
+
+    QString ActionShortcutDispatcher::objectScope(const QObject *object) const {
+        Q_D(const ActionShortcutDispatcher);
+        return d->objectScopes.value(object);
+    }
+
+    void ActionShortcutDispatcher::setObjectScope(QObject *object, const QString &scope) {
+        Q_D(ActionShortcutDispatcher);
+        if (!object)
+            return;
+        if (scope.isEmpty()) {
+            if (d->objectScopes.remove(object))
+                disconnect(object, &QObject::destroyed, this, nullptr);
+            return;
+        }
+        if (!d->objectScopes.contains(object)) {
+            connect(object, &QObject::destroyed, this, [d](QObject *obj) {
+                d->objectScopes.remove(obj);
+            });
+        }
+        d->objectScopes.insert(object, scope);
+    }
+
+    bool ActionShortcutDispatcher::isPending() const {
+        Q_D(const ActionShortcutDispatcher);
+        return d->pendingNode > 0;
+    }
+
+    QKeySequence ActionShortcutDispatcher::pendingKeys() const {
+        Q_D(const ActionShortcutDispatcher);
+        return d->pendingNode > 0 ? sequenceOf(d->pendingChords) : QKeySequence();
+    }
+
+    QStringList ActionShortcutDispatcher::pendingActions() const {
+        Q_D(const ActionShortcutDispatcher);
+        if (d->pendingNode == 0)
+            return {};
+        QStringList result;
+        QVector<int> stack{d->pendingNode};
+        while (!stack.isEmpty()) {
+            const auto &node = d->nodes.at(stack.takeLast());
+            for (const auto &id : node.ids) {
+                if (d->pendingScopes.contains(d->actionScopes.value(id)) && !result.contains(id))
+                    result.append(id);
+            }
+            if (!d->hasBelow(node, d->pendingScopes))
+                continue;
+            for (const int child : node.children) {
+                stack.append(child);
+            }
+        }
+        return result;
+    }
+
+    void ActionShortcutDispatcher::cancelPending() {
+        Q_D(ActionShortcutDispatcher);
+        d->resetPending();
+    }
+
+    bool ActionShortcutDispatcher::processKey(QKeyCombination key, const QObject *receiver) {
+        Q_D(ActionShortcutDispatcher);
+        if (isModifierKey(key.key()))
+            return false;
+        d->flushTrie();
+
+        const int chord = chordOf(key);
+        const bool wasPending = d->pendingNode > 0;
+        const auto scopes = wasPending ? d->pendingScopes : d->effectiveScopes(receiver);
+        const int node = d->nextNode(d->pendingNode, chord, scopes);
+        if (node < 0) {
+            if (!wasPending)
+                return false;
+            // The pending sequence is not continued, complete it and start over from the root
+            const int pendingNode = d->pendingNode;
+            const auto chords = d->pendingChords;
+            d->resetPending();
+            d->trigger(pendingNode, chords, scopes);
+            return processKey(key, receiver);
+        }
+
+        auto chords = d->pendingChords;
+        chords.append(chord);
+        if (chords.size() < 4 && d->hasBelow(d->nodes.at(node), scopes)) {
+            d->setPending(node, chords, scopes);
+            return true;
+        }
+        d->resetPending();
+        d->trigger(node, chords, scopes);
+        return true;
+    }
+
+    bool ActionShortcutDispatcher::eventFilter(QObject *watched, QEvent *event) {
+        Q_D(ActionShortcutDispatcher);
+        switch (event->type()) {
+            case QEvent::ShortcutOverride: {
+                if (d->forwardingOverride)
+                    break;
+                auto e = static_cast<QKeyEvent *>(event);
+                auto &last = d->lastOverride;
+                if (last.event == e && last.timestamp == e->timestamp())
+                    return true;
+
+                // The receiver may claim the key first, e.g. a text field for Ctrl+Z
+                d->forwardingOverride = true;
+                e->ignore();
+                QCoreApplication::sendEvent(watched, e);
+                d->forwardingOverride = false;
+
+                last = {e, e->timestamp(), e->keyCombination().toCombined(), e->isAccepted()};
+                if (!last.result && d->wouldConsume(e->keyCombination(), watched)) {
+                    // Keep the shortcut map of Qt away from the keys of the dispatcher
+                    e->accept();
+                }
+                return true;
+            }
+            case QEvent::KeyPress: {
+                auto e = static_cast<QKeyEvent *>(event);
+                auto &last = d->lastKeyPress;
+                if (last.event == e && last.timestamp == e->timestamp())
+                    return last.result;
+
+                bool result = false;
+                const auto &override = d->lastOverride;
+                // A key claimed by the receiver in the override event is left to it
+                if (!(override.result && override.timestamp == e->timestamp() &&
+                      override.key == e->keyCombination().toCombined()))
+                    result = processKey(e->keyCombination(), watched);
+                last = {e, e->timestamp(), e->keyCombination().toCombined(), result};
+                if (result)
+                    e->accept();
+                return result;
+            }
+            default:
+                break;
+        }
+        return ActionContext::eventFilter(watched, event);
+    }
+
+    void ActionShortcutDispatcher::updateElement(ActionElement element) {
+        Q_D(ActionShortcutDispatcher);
+        if (element != AE_Keymap)
+            return;
+        d->trieDirty = true;
+        d->resetPending();
+    }
+
+    void ActionShortcutDispatcher::updateActions(ActionElement element, const QStringList &ids) {
+        Q_D(ActionShortcutDispatcher);
+        if (element != AE_Keymap)
+            return;
+        d->rebind(ids);
+    }
+
+}
@@ -0,0 +1,80 @@
+#ifndef ACTIONSHORTCUTDISPATCHER_H
+#define ACTIONSHORTCUTDISPATCHER_H
+
+#include <QtGui/QKeySequence>
+
+#include <QAKCore/actioncontext.h>
+
+namespace QAK {
+
+    class ActionShortcutDispatcherPrivate;
+
+    /// \class ActionShortcutDispatcher
+    /// \brief ActionShortcutDispatcher matches the key presses against the resolved keymap of a
+    /// registry and emits \c actionTriggered() for the bound actions, bypassing the shortcut map
+    /// of Qt. The keymap is compiled into a prefix trie of chords, which is patched when the
+    /// registry updates the keymap of some actions.
+    ///
+    /// The dispatcher is added to a registry like any other context, and is installed as an event
+    /// filter on the application or on the windows of either frontend.
+    ///
+    /// An action assigned to a scope is only bound while the scope is active, either because it
+    /// is listed by \c activeScopes() or because the key press is delivered to an object of the
+    /// scope or to one of its children. The actions without a scope are always bound. When a key
+    /// sequence is bound to several actions, the action of the innermost object scope wins, then
+    /// the action of the first active scope, then the unscoped action.
+    class QAK_CORE_EXPORT ActionShortcutDispatcher : public ActionContext {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(ActionShortcutDispatcher)
+        Q_PROPERTY(int chordTimeout READ chordTimeout WRITE setChordTimeout)
+        Q_PROPERTY(bool pending READ isPending NOTIFY pendingChanged)
+        Q_PROPERTY(QKeySequence pendingKeys READ pendingKeys NOTIFY pendingChanged)
+    public:
+        explicit ActionShortcutDispatcher(QObject *parent = nullptr);
+        ~ActionShortcutDispatcher() override;
+
+        /// Returns the time in milliseconds to wait for the next chord of a sequence, a negative
+        /// value waits forever.
+        int chordTimeout() const;
+        void setChordTimeout(int timeout);
+
+        QStringList scopeActions(const QString &scope) const;
+        void setScopeActions(const QString &scope, const QStringList &ids);
+        void removeScope(const QString &scope);
+
+        /// Returns the scopes active regardless of the receiver, in order of priority.
+        QStringList activeScopes() const;
+        void setActiveScopes(const QStringList &scopes);
+
+        /// Returns the scope of the given object, or an empty string.
+        QString objectScope(const QObject *object) const;
+        void setObjectScope(QObject *object, const QString &scope);
+
+        /// Returns whether a chord has been pressed that may be completed by the next one.
+        bool isPending() const;
+        /// Returns the chords pressed so far of the pending sequence.
+        QKeySequence pendingKeys() const;
+        /// Returns the actions that the pending sequence may still trigger.
+        QStringList pendingActions() const;
+        void cancelPending();
+
+        /// Processes a key press delivered to \a receiver, returns whether the key has been
+        /// consumed by a binding or by a pending sequence.
+        bool processKey(QKeyCombination key, const QObject *receiver = nullptr);
+
+        bool eventFilter(QObject *watched, QEvent *event) override;
+
+        void updateElement(ActionElement element) override;
+        void updateActions(ActionElement element, const QStringList &ids) override;
+
+    Q_SIGNALS:
+        void actionTriggered(const QString &id);
+        /// Emitted instead of \c actionTriggered() when the sequence is bound to several actions
+        /// of the same priority.
+        void actionAmbiguous(const QKeySequence &key, const QStringList &ids);
+        void pendingChanged();
+    };
+
+}
+
+#endif // ACTIONSHORTCUTDISPATCHER_H
@@ -0,0 +1,82 @@
+#ifndef ACTIONSHORTCUTDISPATCHER_P_H
+#define ACTIONSHORTCUTDISPATCHER_P_H
+
+//
+//  W A R N I N G !!!
+//  -----------------
+//
+// This file is not part of the QActionKit API. It is used purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or may even be removed.
+//
+
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include <QAKCore/actionshortcutdispatcher.h>
+#include <QAKCore/private/actioncontext_p.h>
+
+namespace QAK {
+
+    class ActionShortcutDispatcherPrivate : public ActionContextPrivate {
+        Q_DECLARE_PUBLIC(ActionShortcutDispatcher)
+    public:
+        ActionShortcutDispatcherPrivate();
+        ~ActionShortcutDispatcherPrivate();
+
+        // A node of the trie stands for the sequence of chords on its path from the root
+        struct Node {
+            QHash<int, int> children;    // combined chord -> node
+            QStringList ids;             // the actions bound to the sequence
+            QHash<QString, int> below;   // scope -> bindings of the strict descendants
+        };
+        QVector<Node> nodes; // 0 is the root
+        QHash<QString, QList<QKeySequence>> boundKeys; // id -> the keys bound in the trie
+        QPointer<ActionRegistry> compiledRegistry;
+        bool trieDirty = true;
+
+        QHash<QString, QString> actionScopes;  // id -> scope
+        QHash<QString, QStringList> scopes;    // scope -> ids
+        QStringList activeScopes;
+        QHash<const QObject *, QString> objectScopes;
+
+        int chordTimeout = 1500;
+        QTimer *chordTimer = nullptr;
+        int pendingNode = 0; // 0 when nothing is pending
+        QVector<int> pendingChords;
+        QStringList pendingScopes; // the scopes the pending sequence was started in
+
+        // The last key event seen by the filter, which may see an event again while it is
+        // propagated to the parents of the receiver
+        struct FilteredEvent {
+            const QEvent *event = nullptr;
+            quint64 timestamp = 0;
+            int key = 0;
+            bool result = false;
+        };
+        FilteredEvent lastOverride;
+        FilteredEvent lastKeyPress;
+        bool forwardingOverride = false;
+
+        void flushTrie();
+        void bind(const QString &id, const QList<QKeySequence> &keys);
+        void unbind(const QString &id);
+        void rebind(const QStringList &ids);
+
+        QStringList effectiveScopes(const QObject *receiver) const;
+        bool hasOwn(const Node &node, const QStringList &scopes) const;
+        bool hasBelow(const Node &node, const QStringList &scopes) const;
+        int nextNode(int node, int chord, const QStringList &scopes) const;
+        bool wouldConsume(QKeyCombination key, const QObject *receiver);
+
+        void setPending(int node, const QVector<int> &chords, const QStringList &scopes);
+        void resetPending();
+        void trigger(int node, const QVector<int> &chords, const QStringList &scopes);
+        void chordTimedOut();
+    };
+
+}
+
+#endif // ACTIONSHORTCUTDISPATCHER_P_H
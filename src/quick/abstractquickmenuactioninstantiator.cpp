@@ -3,6 +3,8 @@
 
 #include <QPointer>
 
+#include <QAKQuick/private/quickmenuadapter_p.h>
+
 namespace QAK {
 
     void AbstractQuickMenuActionInstantiatorPrivate::handleTargetChanged() {
@@ -11,17 +13,27 @@ namespace QAK {
         if (!menu) {
             return;
         }
-        for (int i = 0; i < q->count(); i++) {
-            q->addToMenu(i, q->objectAt(i));
-        }
+        if (q->count())
+            q->addRangeToMenu(0, q->count() - 1);
     }
 
     AbstractQuickMenuActionInstantiator::AbstractQuickMenuActionInstantiator(QObject *parent)
         : QuickActionInstantiator(parent), d_ptr(new AbstractQuickMenuActionInstantiatorPrivate) {
         Q_D(AbstractQuickMenuActionInstantiator);
         d->q_ptr = this;
-        connect(this, &QuickActionInstantiator::objectAdded, this, &AbstractQuickMenuActionInstantiator::addToMenu);
+        connect(this, &QuickActionInstantiator::objectAdded, this, [=](int index, QObject *object) {
+            if (!d->addingRange)
+                addToMenu(index, object);
+        });
+        connect(this, &QuickActionInstantiator::objectsAboutToBeAdded, this, [=] {
+            d->addingRange = true;
+        });
+        connect(this, &QuickActionInstantiator::objectsAdded, this, [=](int first, int last) {
+            d->addingRange = false;
+            addRangeToMenu(first, last);
+        });
         connect(this, &QuickActionInstantiator::objectRemoved, this, &AbstractQuickMenuActionInstantiator::removeFromMenu);
+        connect(this, &QuickActionInstantiator::objectMoved, this, &AbstractQuickMenuActionInstantiator::moveInMenu);
         connect(this, &AbstractQuickMenuActionInstantiator::targetChanged, [=] {
             d->handleTargetChanged();
         });
@@ -29,6 +41,25 @@ namespace QAK {
 
     AbstractQuickMenuActionInstantiator::~AbstractQuickMenuActionInstantiator() = default;
 
+    void AbstractQuickMenuActionInstantiator::addRangeToMenu(int first, int last) {
+        auto menu = target();
+        if (!menu) {
+            return;
+        }
+        const auto adapter = QuickMenuAdapter::of(menu);
+        QObjectList objects;
+        objects.reserve(last - first + 1);
+        for (int i = first; i <= last; i++) {
+            objects.append(objectAt(i));
+        }
+        // The objects the container cannot hold are left to addToMenu() one by one
+        for (int i = first; i <= last; i++) {
+            i += adapter->insertRange(menu, i, objects, i - first);
+            if (i <= last)
+                addToMenu(i, objects.at(i - first));
+        }
+    }
+
     QObject *AbstractQuickMenuActionInstantiator::parent() const {
         return QObject::parent();
     }
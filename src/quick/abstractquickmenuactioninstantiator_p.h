@@ -25,7 +25,10 @@ namespace QAK {
 
     protected:
         virtual void addToMenu(int index, QObject *object) = 0;
+        // Inserts the objects from first to last, which are already at their final indexes
+        virtual void addRangeToMenu(int first, int last);
         virtual void removeFromMenu(int index, QObject *object) = 0;
+        virtual void moveInMenu(int from, int to, QObject *object) = 0;
 
     signals:
         void parentChanged();
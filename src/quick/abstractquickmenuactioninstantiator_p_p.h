@@ -13,6 +13,7 @@ namespace QAK {
 
         QPointer<QObject> target;
         bool isTargetExplicitlySet{};
+        bool addingRange{}; // the objectAdded() of a range are inserted at once by objectsAdded()
 
         void handleTargetChanged();
     };
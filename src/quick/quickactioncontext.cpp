@@ -2,16 +2,100 @@
 #include "quickactioncontext_p.h"
 
 #include <QQmlComponent>
+#include <QtQuick/QQuickItem>
 
 #include <QtQuickTemplates2/private/qquickaction_p.h>
 #include <QtQuickTemplates2/private/qquickmenu_p.h>
 
 #include <QAKCore/actionregistry.h>
+#include <QAKQuick/private/quickactioninfoview_p.h>
 #include <QAKQuick/private/quickactioninstantiatorattachedtype_p_p.h>
 #include <QAKQuick/private/quickactioninstantiator_p_p.h>
 
 namespace QAK {
 
+    void QuickActionContextPrivate::trackComponent(QQmlComponent *component) {
+        Q_Q(QuickActionContext);
+        if (pool.components.contains(component))
+            return;
+        pool.components.insert(component);
+        QObject::connect(component, &QObject::destroyed, q, [this, component] {
+            pool.components.remove(component);
+            const auto objects = pool.parked.take(component);
+            pool.parkedCount -= int(objects.size());
+            qDeleteAll(objects);
+        });
+    }
+    QObject *QuickActionContextPrivate::takeParkedObject(QQmlComponent *component) {
+        auto it = pool.parked.find(component);
+        if (it == pool.parked.end() || it->isEmpty())
+            return nullptr;
+        pool.parkedCount--;
+        pool.reusedCount++;
+        return it->takeLast();
+    }
+    void QuickActionContextPrivate::adoptObject(QQmlComponent *component, QObject *object) {
+        Q_Q(QuickActionContext);
+        pool.createdCount++;
+        trackComponent(component);
+        pool.origins.insert(object, component);
+        if (auto action = qobject_cast<QQuickAction *>(object)) {
+            pool.actionStates.insert(object, {action->shortcut(), action->isCheckable(),
+                                              action->isChecked(), action->isEnabled()});
+        }
+        QObject::connect(object, &QObject::destroyed, q, [this, object] {
+            pool.actionStates.remove(object);
+            if (auto it = pool.parked.find(pool.origins.take(object)); it != pool.parked.end()) {
+                if (it->removeOne(object))
+                    pool.parkedCount--;
+            }
+        });
+    }
+    void QuickActionContextPrivate::trimPool() {
+        for (auto it = pool.parked.begin(); it != pool.parked.end(); ++it) {
+            auto &objects = it.value();
+            while (!objects.isEmpty() &&
+                   (objects.size() > pool.capacity || pool.parkedCount > pool.totalCapacity)) {
+                objects.takeLast()->deleteLater();
+                pool.parkedCount--;
+                pool.discardedCount++;
+            }
+        }
+    }
+
+    QuickActionInfoView *QuickActionContextPrivate::acquireInfoView(const QString &id) {
+        Q_Q(QuickActionContext);
+        auto &view = infoViews[id];
+        if (!view) {
+            view = new QuickActionInfoView(id, q);
+            if (auto registry = q->registry())
+                view->update(registry->actionInfo(id), q, QuickActionInstantiatorPrivate::All);
+        }
+        view->refCount++;
+        return view;
+    }
+    void QuickActionContextPrivate::releaseInfoView(QuickActionInfoView *view) {
+        if (--view->refCount > 0)
+            return;
+        infoViews.remove(view->id);
+        view->deleteLater();
+    }
+    void QuickActionContextPrivate::updateInfoViews(int property, const QStringList &ids) {
+        Q_Q(QuickActionContext);
+        auto registry = q->registry();
+        if (!registry)
+            return;
+        if (ids.isEmpty()) {
+            for (auto view : std::as_const(infoViews))
+                view->update(registry->actionInfo(view->id), q, property);
+            return;
+        }
+        for (const auto &id : ids) {
+            if (auto view = infoViews.value(id))
+                view->update(registry->actionInfo(id), q, property);
+        }
+    }
+
     QuickActionContext::QuickActionContext(QObject *parent)
         : ActionContext(parent), d_ptr(new QuickActionContextPrivate) {
         Q_D(QuickActionContext);
@@ -35,8 +119,7 @@ namespace QAK {
         auto attachedInfoObject = qobject_cast<QuickActionInstantiatorAttachedType *>(
             qmlAttachedPropertiesObject<QuickActionInstantiator>(object));
         Q_ASSERT(attachedInfoObject);
-        attachedInfoObject->init(registry()->actionInfo(id), this,
-                                 QuickActionInstantiatorPrivate::All);
+        attachedInfoObject->init(id, this);
         if (auto action = qobject_cast<QQuickAction *>(object)) {
             action->setText(attachedInfoObject->text());
             auto icon = action->icon();
@@ -50,9 +133,11 @@ namespace QAK {
                 icon.setColor(attachedInfoObject->icon().color());
             }
             action->setIcon(icon);
-            if (!attachedInfoObject->shortcuts().isEmpty()) {
-                action->setShortcut(attachedInfoObject->shortcuts().first());
-            }
+            // A recycled action may carry the shortcut of another id
+            action->setShortcut(attachedInfoObject->shortcuts().value(0));
+            // Reads the id on each trigger, so that a recycled action is connected once
+            QObject::connect(action, &QQuickAction::triggered, attachedInfoObject,
+                             &QuickActionInstantiatorAttachedType::recordUsage, Qt::UniqueConnection);
         } else if (auto menu = qobject_cast<QQuickMenu *>(object)) {
             menu->setTitle(attachedInfoObject->text());
             auto icon = menu->icon();
@@ -106,22 +191,142 @@ namespace QAK {
         }
     }
 
+    QObject *QuickActionContext::acquireObject(QQmlComponent *component) {
+        Q_D(QuickActionContext);
+        if (!component)
+            return nullptr;
+        if (auto object = d->takeParkedObject(component))
+            return object;
+        auto object = component->create(component->creationContext());
+        if (object)
+            d->adoptObject(component, object);
+        return object;
+    }
+    void QuickActionContext::releaseObject(QObject *object) {
+        Q_D(QuickActionContext);
+        if (!object)
+            return;
+        auto &pool = d->pool;
+        auto component = pool.origins.value(object);
+        if (!component || pool.parked.value(component).size() >= pool.capacity ||
+            pool.parkedCount >= pool.totalCapacity) {
+            if (component)
+                pool.discardedCount++;
+            object->deleteLater();
+            return;
+        }
+
+        // Drop what the previous user connected to the object through the attached type
+        if (auto attachedInfoObject = qobject_cast<QuickActionInstantiatorAttachedType *>(
+                qmlAttachedPropertiesObject<QuickActionInstantiator>(object, false))) {
+            disconnect(attachedInfoObject, nullptr, object, nullptr);
+            attachedInfoObject->setInstantiator(nullptr);
+        }
+        // Restore the state the component created the action with, the next user may not set it
+        if (auto action = qobject_cast<QQuickAction *>(object)) {
+            const auto &state = pool.actionStates[object];
+            action->setShortcut(state.shortcut);
+            action->setCheckable(state.checkable);
+            action->setChecked(state.checked);
+            action->setEnabled(state.enabled);
+        }
+        if (auto item = qobject_cast<QQuickItem *>(object)) {
+            item->setParentItem(nullptr);
+        }
+        object->setParent(this);
+
+        pool.parked[component].append(object);
+        pool.parkedCount++;
+        pool.releasedCount++;
+    }
+    void QuickActionContext::clearObjectPool() {
+        Q_D(QuickActionContext);
+        auto &pool = d->pool;
+        for (const auto &objects : std::as_const(pool.parked)) {
+            for (auto object : objects) {
+                object->deleteLater();
+            }
+        }
+        pool.parked.clear();
+        pool.parkedCount = 0;
+    }
+    QVariantMap QuickActionContext::objectPoolStatistics() const {
+        Q_D(const QuickActionContext);
+        const auto &pool = d->pool;
+        return {
+            {"created",   pool.createdCount  },
+            {"reused",    pool.reusedCount   },
+            {"released",  pool.releasedCount },
+            {"discarded", pool.discardedCount},
+            {"parked",    pool.parkedCount   },
+        };
+    }
+    int QuickActionContext::objectPoolCapacity() const {
+        Q_D(const QuickActionContext);
+        return d->pool.capacity;
+    }
+    void QuickActionContext::setObjectPoolCapacity(int capacity) {
+        Q_D(QuickActionContext);
+        capacity = qMax(0, capacity);
+        if (d->pool.capacity != capacity) {
+            d->pool.capacity = capacity;
+            d->trimPool();
+            emit objectPoolCapacityChanged();
+        }
+    }
+    int QuickActionContext::objectPoolTotalCapacity() const {
+        Q_D(const QuickActionContext);
+        return d->pool.totalCapacity;
+    }
+    void QuickActionContext::setObjectPoolTotalCapacity(int capacity) {
+        Q_D(QuickActionContext);
+        capacity = qMax(0, capacity);
+        if (d->pool.totalCapacity != capacity) {
+            d->pool.totalCapacity = capacity;
+            d->trimPool();
+            emit objectPoolTotalCapacityChanged();
+        }
+    }
+
     void QuickActionContext::updateElement(ActionElement element) {
+        Q_D(QuickActionContext);
         switch (element) {
             case AE_Layouts:
                 emit layoutsAboutToUpdate();
                 break;
             case AE_Texts:
+                d->updateInfoViews(QuickActionInstantiatorPrivate::Text, {});
                 emit textsAboutToUpdate();
                 break;
             case AE_Keymap:
+                d->updateInfoViews(QuickActionInstantiatorPrivate::Keymap, {});
                 emit keymapAboutToUpdate();
                 break;
             case AE_Icons:
+                d->updateInfoViews(QuickActionInstantiatorPrivate::Icon, {});
                 emit iconsAboutToUpdate();
                 break;
         }
     }
+    void QuickActionContext::updateActions(ActionElement element, const QStringList &ids) {
+        Q_D(QuickActionContext);
+        int property;
+        switch (element) {
+            case AE_Texts:
+                property = QuickActionInstantiatorPrivate::Text;
+                break;
+            case AE_Keymap:
+                property = QuickActionInstantiatorPrivate::Keymap;
+                break;
+            case AE_Icons:
+                property = QuickActionInstantiatorPrivate::Icon;
+                break;
+            default:
+                updateElement(element);
+                return;
+        }
+        d->updateInfoViews(property, ids);
+    }
 
 }
 
@@ -1,6 +1,8 @@
 #ifndef QUICKACTIONCONTEXT_H
 #define QUICKACTIONCONTEXT_H
 
+#include <QtCore/QVariantMap>
+
 #include <QAKCore/actioncontext.h>
 #include <QAKQuick/qakquickglobal.h>
 
@@ -20,6 +22,11 @@ namespace QAK {
                        setSeparatorComponent NOTIFY separatorComponentChanged)
         Q_PROPERTY(QQmlComponent *stretchComponent READ stretchComponent WRITE setStretchComponent
                        NOTIFY stretchComponentChanged)
+        Q_PROPERTY(QString iconTheme READ iconTheme WRITE setIconTheme NOTIFY iconThemeChanged)
+        Q_PROPERTY(int objectPoolCapacity READ objectPoolCapacity WRITE setObjectPoolCapacity NOTIFY
+                       objectPoolCapacityChanged)
+        Q_PROPERTY(int objectPoolTotalCapacity READ objectPoolTotalCapacity WRITE
+                       setObjectPoolTotalCapacity NOTIFY objectPoolTotalCapacityChanged)
 
     public:
         explicit QuickActionContext(QObject *parent = nullptr);
@@ -39,7 +46,25 @@ namespace QAK {
         QQmlComponent *stretchComponent() const;
         void setStretchComponent(QQmlComponent *component);
 
+        /// Returns an object of \a component, reusing a released one if any is parked.
+        Q_INVOKABLE QObject *acquireObject(QQmlComponent *component);
+        /// Parks \a object for reuse if it was acquired from the pool and the caps allow it,
+        /// otherwise deletes it later. A parked action gets back the shortcut and the checkable,
+        /// checked and enabled states its component created it with.
+        Q_INVOKABLE void releaseObject(QObject *object);
+        Q_INVOKABLE void clearObjectPool();
+        Q_INVOKABLE QVariantMap objectPoolStatistics() const;
+
+        /// The maximum number of parked objects per component.
+        int objectPoolCapacity() const;
+        void setObjectPoolCapacity(int capacity);
+
+        /// The maximum number of parked objects of all components.
+        int objectPoolTotalCapacity() const;
+        void setObjectPoolTotalCapacity(int capacity);
+
         void updateElement(ActionElement element) override;
+        void updateActions(ActionElement element, const QStringList &ids) override;
 
     signals:
         void actionChanged(const QString &id);
@@ -47,12 +72,19 @@ namespace QAK {
         void menuComponentChanged();
         void separatorComponentChanged();
         void stretchComponentChanged();
+        void objectPoolCapacityChanged();
+        void objectPoolTotalCapacityChanged();
         void layoutsAboutToUpdate();
         void textsAboutToUpdate();
         void iconsAboutToUpdate();
         void keymapAboutToUpdate();
 
     private:
+        friend class QuickActionInstantiatorPrivate;
+        friend class QuickActionInstantiatorAttachedType;
+        friend class QuickActionLayoutsListModelPrivate;
+        friend class QuickActionLayoutsListModel;
+
         QScopedPointer<QuickActionContextPrivate> d_ptr;
     };
 
@@ -3,10 +3,14 @@
 
 #include <QAKQuick/quickactioncontext.h>
 
+#include <QKeySequence>
 #include <QPointer>
+#include <QSet>
 
 namespace QAK {
 
+    class QuickActionInfoView;
+
     class QuickActionContextPrivate {
         Q_DECLARE_PUBLIC(QuickActionContext)
     public:
@@ -17,6 +21,41 @@ namespace QAK {
         QPointer<QQmlComponent> separatorComponent;
         QPointer<QQmlComponent> stretchComponent;
 
+        // Resolved action properties shared by the attached info objects, by action id
+        QHash<QString, QuickActionInfoView *> infoViews;
+        QuickActionInfoView *acquireInfoView(const QString &id);
+        void releaseInfoView(QuickActionInfoView *view);
+        void updateInfoViews(int property, const QStringList &ids);
+
+        // Released objects parked per component for reuse
+        struct ObjectPool {
+            QHash<QQmlComponent *, QObjectList> parked;
+            QHash<QObject *, QQmlComponent *> origins; // pooled object -> component
+            struct ActionState {
+                QKeySequence shortcut;
+                bool checkable;
+                bool checked;
+                bool enabled;
+            };
+            QHash<QObject *, ActionState> actionStates; // pooled action -> state when created
+            QSet<QQmlComponent *> components;
+            int capacity = 16;       // per component
+            int totalCapacity = 256; // all components
+            int parkedCount = 0;
+
+            // statistics
+            int createdCount = 0;
+            int reusedCount = 0;
+            int releasedCount = 0;
+            int discardedCount = 0;
+        };
+        ObjectPool pool;
+
+        void trackComponent(QQmlComponent *component);
+        QObject *takeParkedObject(QQmlComponent *component);
+        // Makes an object created elsewhere (e.g. incubated) recyclable
+        void adoptObject(QQmlComponent *component, QObject *object);
+        void trimPool();
     };
 }
 
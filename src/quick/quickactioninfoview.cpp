@@ -0,0 +1,89 @@
+#include "quickactioninfoview_p.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKQuick/quickactioncontext.h>
+#include <QAKQuick/private/quickactioninstantiator_p_p.h>
+
+namespace QAK {
+
+    QuickActionInfoView::QuickActionInfoView(const QString &id, QObject *parent)
+        : QObject(parent), id(id) {
+    }
+    QuickActionInfoView::~QuickActionInfoView() = default;
+
+    void QuickActionInfoView::update(const ActionItemInfo &info, QuickActionContext *context, int property) {
+        if (property & QuickActionInstantiatorPrivate::Text) {
+            auto newText = info.text(true);
+            if (newText.isEmpty()) {
+                newText = info.text();
+            }
+            if (newText.isEmpty()) {
+                newText = id;
+            }
+            if (text != newText) {
+                text = newText;
+                emit textChanged();
+            }
+            auto newDescription = info.description(true);
+            if (newDescription.isEmpty()) {
+                newDescription = info.description();
+            }
+            if (description != newDescription) {
+                description = newDescription;
+                emit descriptionChanged();
+            }
+
+            // Convert ActionAttributeKey map to QVariantList format
+            QVariantList newAttributes;
+            const auto infoAttributes = info.attributes();
+            for (auto it = infoAttributes.begin(); it != infoAttributes.end(); ++it) {
+                QVariantMap attributeMap;
+                attributeMap.insert("name", it.key().name);
+                attributeMap.insert("namespace", it.key().namespaceUri);
+                attributeMap.insert("value", it.value());
+                newAttributes.append(attributeMap);
+            }
+            if (attributes != newAttributes) {
+                attributes = newAttributes;
+                emit attributesChanged();
+            }
+        }
+        const auto registry = context ? context->registry() : nullptr;
+        if (!registry) {
+            return;
+        }
+        if (property & QuickActionInstantiatorPrivate::Icon) {
+            const auto actionIcon = registry->actionIcon(context->iconTheme(), info.icon());
+            const auto color = QColor::fromString(actionIcon.currentColor());
+            QQuickIcon newIcons[4];
+            for (int i = 0; i < 4; i++) {
+                bool enabledFlag = i & 1;
+                bool checkedFlag = i & 2;
+                newIcons[i].setSource(actionIcon.url(enabledFlag, checkedFlag));
+                newIcons[i].setColor(color);
+            }
+            for (auto &icon : newIcons) {
+                if (icon.source().isEmpty()) {
+                    icon = newIcons[1];
+                }
+            }
+            if (!std::equal(std::begin(icons), std::end(icons), std::begin(newIcons))) {
+                std::copy(std::begin(newIcons), std::end(newIcons), std::begin(icons));
+                emit iconChanged();
+            }
+        }
+        if (property & QuickActionInstantiatorPrivate::Keymap) {
+            auto newShortcuts = registry->actionShortcuts(id);
+            if (shortcuts != newShortcuts) {
+                shortcuts = newShortcuts;
+                emit shortcutsChanged();
+            }
+        }
+    }
+
+}
+
+#include "moc_quickactioninfoview_p.cpp"
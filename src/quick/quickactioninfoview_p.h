@@ -0,0 +1,45 @@
+#ifndef QUICKACTIONINFOVIEW_P_H
+#define QUICKACTIONINFOVIEW_P_H
+
+#include <QObject>
+#include <QKeySequence>
+#include <QVariantList>
+#include <QtQuickTemplates2/private/qquickaction_p.h>
+
+namespace QAK {
+
+    class ActionItemInfo;
+
+    class QuickActionContext;
+
+    // The resolved properties of an action, shared by all attached info objects of the same id in
+    // a context and reference counted by them
+    class QuickActionInfoView : public QObject {
+        Q_OBJECT
+    public:
+        explicit QuickActionInfoView(const QString &id, QObject *parent = nullptr);
+        ~QuickActionInfoView() override;
+
+        // property is a combination of QuickActionInstantiatorPrivate::ActionProperty
+        void update(const ActionItemInfo &info, QuickActionContext *context, int property);
+
+        QString id;
+        QString text;
+        QString description;
+        QList<QKeySequence> shortcuts;
+        QVariantList attributes;
+        QQuickIcon icons[4]; // [enabled | checked << 1]
+
+        int refCount = 0;
+
+    signals:
+        void textChanged();
+        void descriptionChanged();
+        void iconChanged();
+        void shortcutsChanged();
+        void attributesChanged();
+    };
+
+}
+
+#endif //QUICKACTIONINFOVIEW_P_H
@@ -1,19 +1,40 @@
 #include "quickactioninstantiator_p.h"
 #include "quickactioninstantiator_p_p.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <QQmlComponent>
 #include <QQmlEngine>
+#include <QQmlIncubator>
 #include <QQmlInfo>
+#include <QTimer>
 #include <QtQuickTemplates2/private/qquickaction_p.h>
 #include <QtQuickTemplates2/private/qquickmenu_p.h>
 
 #include <QAKQuick/quickactioncontext.h>
+#include <QAKQuick/private/quickactioncontext_p.h>
 #include <QAKQuick/private/quickactioninstantiatorattachedtype_p.h>
 #include <QAKQuick/private/quickmenuactioninstantiator_p.h>
 
 namespace QAK {
 
-    static const char *ELEMENT_PROPERTY = "_qak_element";
+    class QuickActionObjectIncubator : public QQmlIncubator {
+    public:
+        QuickActionObjectIncubator(QuickActionInstantiatorPrivate *d, const QuickActionInstantiatorPrivate::ObjectKey &key, int target)
+            : QQmlIncubator(Asynchronous), d(d), key(key), target(target) {
+        }
+
+        QuickActionInstantiatorPrivate *d;
+        QuickActionInstantiatorPrivate::ObjectKey key;
+        int target;
+
+    protected:
+        void statusChanged(Status status) override {
+            if (status == Ready || status == Error)
+                d->objectIncubated(this);
+        }
+    };
 
     QQmlComponent *QuickActionInstantiatorPrivate::menuComponent() const {
         return isMenuComponentExplicitlySet ? menuComponent_override.get() : context ? context->menuComponent() : nullptr;
@@ -24,67 +45,122 @@ namespace QAK {
     QQmlComponent *QuickActionInstantiatorPrivate::stretchComponent() const {
         return isStretchComponentExplicitlySet ? stretchComponent_override.get() : context ? context->stretchComponent() : nullptr;
     }
-    void QuickActionInstantiatorPrivate::addObject(int index, QObject *object) {
+    void QuickActionInstantiatorPrivate::addObjects(int index, const QObjectList &newObjects, const QVector<ObjectKey> &keys) {
         Q_Q(QuickActionInstantiator);
-        objects.insert(index, object);
-        emit q->objectAdded(index, object);
+        if (newObjects.isEmpty())
+            return;
+        const int last = index + int(newObjects.size()) - 1;
+        emit q->objectsAboutToBeAdded(index, last);
+        objects.insert(index, newObjects.size(), nullptr);
+        records.insert(index, newObjects.size(), {});
+        for (int i = 0; i < newObjects.size(); i++) {
+            objects[index + i] = newObjects[i];
+            records[index + i] = {keys[i].type, keys[i].id};
+        }
+        for (int i = index; i <= last; i++) {
+            emit q->objectAdded(i, objects.at(i));
+        }
+        emit q->objectsAdded(index, last);
         emit q->countChanged();
     }
     void QuickActionInstantiatorPrivate::removeObject(int index) {
         Q_Q(QuickActionInstantiator);
         emit q->objectRemoved(index, objects.at(index));
-        objects.at(index)->deleteLater();
+        releaseObject(objects.at(index));
         objects.remove(index);
+        records.remove(index);
         emit q->countChanged();
     }
     void QuickActionInstantiatorPrivate::modifyObject(int index, QObject *object) {
         Q_Q(QuickActionInstantiator);
         emit q->objectRemoved(index, objects.at(index));
-        objects.at(index)->deleteLater();
+        releaseObject(objects.at(index));
         objects[index] = object;
         emit q->objectAdded(index, object);
     }
-    QObjectList QuickActionInstantiatorPrivate::createObject(const ActionLayoutEntry &entry) const {
-        QObject *o;
-        QQmlComponent *component;
+    QObject *QuickActionInstantiatorPrivate::acquireObject(QQmlComponent *component) const {
+        if (context)
+            return context->acquireObject(component);
+        return component->create(component->creationContext());
+    }
+    void QuickActionInstantiatorPrivate::releaseObject(QObject *object) const {
+        if (context)
+            context->releaseObject(object);
+        else
+            object->deleteLater();
+    }
+    void QuickActionInstantiatorPrivate::moveObject(int from, int to) {
+        Q_Q(QuickActionInstantiator);
+        auto object = objects.at(from);
+        objects.move(from, to);
+        records.move(from, to);
+        emit q->objectMoved(from, to, object);
+    }
+    void QuickActionInstantiatorPrivate::planObjects(const ActionLayoutEntry &entry, QVector<ObjectKey> &plan) const {
         switch (entry.type()) {
             case ActionLayoutEntry::Separator:
-                o = createSeparator();
-                if (o)
-                    return {o};
+                if (separatorComponent())
+                    plan.append({ActionLayoutEntry::Separator, {}, 0});
                 break;
             case ActionLayoutEntry::Stretch:
-                o = createStretch();
-                if (o)
-                    return {o};
+                if (stretchComponent())
+                    plan.append({ActionLayoutEntry::Stretch, {}, 0});
                 break;
             case ActionLayoutEntry::Action:
-                component = context->action(entry.id());
-                if (!component)
-                    break;
-                return {createAction(entry.id(), component)};
+                if (context->action(entry.id()))
+                    plan.append({ActionLayoutEntry::Action, entry.id(), 0});
+                break;
             case ActionLayoutEntry::Menu:
                 if (menuComponent())
-                    return {createMenu(entry.id())};
+                    plan.append({ActionLayoutEntry::Menu, entry.id(), 0});
                 break;
-            case ActionLayoutEntry::Group:
-                QObjectList list;
-                o = createSeparator();
-                if (o)
-                    list.append(o);
-                for (const auto &child : context->registry()->layouts().adjacencyMap().value(entry.id())) {
-                    list += createObject(child);
-                }
-                o = createSeparator();
-                if (o)
-                    list.append(o);
-                return list;
+            default:
+                break;
+        }
+    }
+    QObject *QuickActionInstantiatorPrivate::createObject(const ObjectKey &key) const {
+        switch (key.type) {
+            case ActionLayoutEntry::Separator:
+                return createSeparator();
+            case ActionLayoutEntry::Stretch:
+                return createStretch();
+            case ActionLayoutEntry::Action:
+                return createAction(key.id, context->action(key.id));
+            case ActionLayoutEntry::Menu:
+                return createMenu(key.id);
+            default:
+                return nullptr;
+        }
+    }
+    QQmlComponent *QuickActionInstantiatorPrivate::componentOf(const ObjectKey &key) const {
+        switch (key.type) {
+            case ActionLayoutEntry::Separator:
+                return separatorComponent();
+            case ActionLayoutEntry::Stretch:
+                return stretchComponent();
+            case ActionLayoutEntry::Action:
+                return context->action(key.id);
+            case ActionLayoutEntry::Menu:
+                return menuComponent();
+            default:
+                return nullptr;
+        }
+    }
+    QObject *QuickActionInstantiatorPrivate::setupObject(const ObjectKey &key, QObject *object) const {
+        switch (key.type) {
+            case ActionLayoutEntry::Action:
+                return setupAction(key.id, object);
+            case ActionLayoutEntry::Menu:
+                return setupMenu(key.id, object);
+            default:
+                return object;
         }
-        return {};
     }
     QObject *QuickActionInstantiatorPrivate::createAction(const QString &actionId, QQmlComponent *component) const {
-        auto object = component->create(component->creationContext());
-        auto attachedInfoObject = attachInfoObjectTo(actionId, object, All);
+        return setupAction(actionId, acquireObject(component));
+    }
+    QObject *QuickActionInstantiatorPrivate::setupAction(const QString &actionId, QObject *object) const {
+        auto attachedInfoObject = attachInfoObjectTo(actionId, object);
         if (auto action = qobject_cast<QQuickAction *>(object)) {
             action->setText(attachedInfoObject->text());
             auto icon = action->icon();
@@ -98,9 +174,11 @@ namespace QAK {
                 icon.setColor(attachedInfoObject->icon().color());
             }
             action->setIcon(icon);
-            if (!attachedInfoObject->shortcuts().isEmpty()) {
-                action->setShortcut(attachedInfoObject->shortcuts().first());
-            }
+            // A recycled action may carry the shortcut of another id
+            action->setShortcut(attachedInfoObject->shortcuts().value(0));
+            // Reads the id on each trigger, so that a recycled action is connected once
+            QObject::connect(action, &QQuickAction::triggered, attachedInfoObject,
+                             &QuickActionInstantiatorAttachedType::recordUsage, Qt::UniqueConnection);
         } else if (auto menu = qobject_cast<QQuickMenu *>(object)) {
             menu->setTitle(attachedInfoObject->text());
             auto icon = menu->icon();
@@ -118,9 +196,11 @@ namespace QAK {
         return object;
     }
     QObject *QuickActionInstantiatorPrivate::createMenu(const QString &menuId) const {
+        return setupMenu(menuId, menuComponent()->create(menuComponent()->creationContext()));
+    }
+    QObject *QuickActionInstantiatorPrivate::setupMenu(const QString &menuId, QObject *menu) const {
         Q_Q(const QuickActionInstantiator);
-        auto menu = menuComponent()->create(context->menuComponent()->creationContext());
-        auto attachedInfoObject = attachInfoObjectTo(menuId, menu, All);
+        auto attachedInfoObject = attachInfoObjectTo(menuId, menu);
         if (auto menuMenu = qobject_cast<QQuickMenu *>(menu)) {
             menuMenu->setTitle(attachedInfoObject->text());
             auto icon = menuMenu->icon();
@@ -174,49 +254,87 @@ namespace QAK {
                 instantiator->resetStretchComponent();
             }
         });
-        
-        instantiator->QuickActionInstantiator::d_func()->updateLayouts();
-        setElement(menu, Menu);
+
+        instantiator->setAsynchronous(asynchronous);
+        QObject::connect(q, &QuickActionInstantiator::asynchronousChanged, instantiator, [=] {
+            instantiator->setAsynchronous(asynchronous);
+        });
+        instantiator->setIncubationBudget(incubationBudget);
+        QObject::connect(q, &QuickActionInstantiator::incubationBudgetChanged, instantiator, [=] {
+            instantiator->setIncubationBudget(incubationBudget);
+        });
+
+        instantiator->setLazySubmenus(lazySubmenus);
+        QObject::connect(q, &QuickActionInstantiator::lazySubmenusChanged, instantiator, [=] {
+            instantiator->setLazySubmenus(lazySubmenus);
+        });
+
+        auto instantiatorPrivate = instantiator->QuickActionInstantiator::d_func();
+        auto popup = qobject_cast<QQuickMenu *>(menu);
+        if (lazySubmenus && popup) {
+            // Populated when the menu is about to be shown for the first time
+            instantiatorPrivate->populated = false;
+            QObject::connect(popup, &QQuickPopup::aboutToShow, instantiator, [instantiatorPrivate] {
+                instantiatorPrivate->populate();
+            });
+            if (prefetchSubmenus)
+                schedulePrefetch(instantiator);
+        } else {
+            instantiatorPrivate->updateLayouts();
+        }
         return menu;
     }
-    QObject *QuickActionInstantiatorPrivate::createSeparator() const {
-        if (separatorComponent()) {
-            auto separator = separatorComponent()->create(separatorComponent()->creationContext());
-            setElement(separator, Separator);
-            return separator;
+    void QuickActionInstantiatorPrivate::populate() {
+        if (populated)
+            return;
+        populated = true;
+        updateLayouts();
+    }
+    void QuickActionInstantiatorPrivate::schedulePrefetch(QuickActionInstantiator *instantiator) const {
+        Q_Q(const QuickActionInstantiator);
+        prefetchQueue.append(instantiator);
+        if (!prefetchTimer) {
+            // Populate one submenu per event loop iteration, so that user input is not delayed
+            prefetchTimer = new QTimer(const_cast<QuickActionInstantiator *>(q));
+            prefetchTimer->setInterval(0);
+            QObject::connect(prefetchTimer, &QTimer::timeout, q, [this] {
+                while (!prefetchQueue.isEmpty()) {
+                    if (auto instantiator = prefetchQueue.takeFirst()) {
+                        instantiator->QuickActionInstantiator::d_func()->populate();
+                        break;
+                    }
+                }
+                if (prefetchQueue.isEmpty())
+                    prefetchTimer->stop();
+            });
         }
+        prefetchTimer->start();
+    }
+    QObject *QuickActionInstantiatorPrivate::createSeparator() const {
+        if (separatorComponent())
+            return acquireObject(separatorComponent());
         return nullptr;
     }
     QObject *QuickActionInstantiatorPrivate::createStretch() const {
-        if (stretchComponent()) {
-            auto stretch = stretchComponent()->create(stretchComponent()->creationContext());
-            setElement(stretch, Stretch);
-            return stretch;
-        }
+        if (stretchComponent())
+            return acquireObject(stretchComponent());
         return nullptr;
     }
-    QuickActionInstantiatorAttachedType *QuickActionInstantiatorPrivate::attachInfoObjectTo(const QString &id, QObject *object, ActionProperty property) const {
-        Q_Q(const QuickActionInstantiator);
-        auto info = context->registry()->actionInfo(id);
+    QuickActionInstantiatorAttachedType *QuickActionInstantiatorPrivate::attachInfoObjectTo(const QString &id, QObject *object) const {
         auto attachedInfoObject = qobject_cast<QuickActionInstantiatorAttachedType *>(qmlAttachedPropertiesObject<QuickActionInstantiator>(object));
-        attachedInfoObject->init(info, context, property);
-        attachedInfoObject->setInstantiator(const_cast<QuickActionInstantiator *>(q));
+        initInfoObject(attachedInfoObject, id);
         return attachedInfoObject;
     }
+    void QuickActionInstantiatorPrivate::initInfoObject(QuickActionInstantiatorAttachedType *attachedInfoObject, const QString &id) const {
+        Q_Q(const QuickActionInstantiator);
+        attachedInfoObject->init(id, context);
+        attachedInfoObject->setInstantiator(const_cast<QuickActionInstantiator *>(q));
+    }
     void QuickActionInstantiatorPrivate::updateContext() {
         Q_Q(QuickActionInstantiator);
         QObject::connect(context, &QuickActionContext::layoutsAboutToUpdate, q, [=] {
             updateLayouts();
         });
-        QObject::connect(context, &QuickActionContext::textsAboutToUpdate, q, [=] {
-            updateActionProperty(Text);
-        });
-        QObject::connect(context, &QuickActionContext::iconsAboutToUpdate, q, [=] {
-            updateActionProperty(Icon);
-        });
-        QObject::connect(context, &QuickActionContext::keymapAboutToUpdate, q, [=] {
-            updateActionProperty(Keymap);
-        });
         QObject::connect(context, &QuickActionContext::menuComponentChanged, q, [=] {
             if (!isMenuComponentExplicitlySet) {
                 updateElement(Menu);
@@ -239,80 +357,341 @@ namespace QAK {
     }
     void QuickActionInstantiatorPrivate::updateLayouts() {
         Q_Q(QuickActionInstantiator);
-        while (!objects.isEmpty()) {
-            removeObject(objects.size() - 1);
-        }
-        if (!context || !context->registry())
+        cancelIncubation();
+        if (!populated)
             return;
-        auto info = context->registry()->actionInfo(id);
-        if (info.isNull())
-            return;
-        auto children = context->registry()->layouts().adjacencyMap().value(info.id());
-        for (int childIndex = 0; childIndex < children.size(); childIndex++) {
-            const auto &child = children[childIndex];
-            auto list = createObject(child);
-            QObjectList filteredList;
-            filteredList.reserve(list.size());
-            for (int i = 0; i < list.size(); i++) {
-                auto object = list[i];
-                if (getElement(object) == Separator) {
-                    bool shouldDeleteSeparator =
-                        !filteredList.isEmpty() && getElement(filteredList.last()) == Separator ||
-                        filteredList.isEmpty() && (objects.isEmpty() || getElement(objects.last()) == Separator) ||
-                        i == list.size() - 1 && childIndex == children.size() - 1;
-                    if (shouldDeleteSeparator) {
-                       delete object;
-                        list[i] = nullptr;
+        QVector<ObjectKey> plan;
+        if (context && context->registry()) {
+            auto info = context->registry()->actionInfo(id);
+            if (!info.isNull()) {
+                QVector<ObjectKey> rawPlan;
+                for (const auto &child : context->registry()->layouts().flattenedChildren(info.id())) {
+                    planObjects(child, rawPlan);
+                }
+
+                // The unavailable entries may leave separators to collapse again
+                plan.reserve(rawPlan.size());
+                for (const auto &key : std::as_const(rawPlan)) {
+                    if (key.type == ActionLayoutEntry::Separator &&
+                        (plan.isEmpty() || plan.last().type == ActionLayoutEntry::Separator)) {
                         continue;
                     }
+                    plan.append(key);
+                }
+                while (!plan.isEmpty() && plan.last().type == ActionLayoutEntry::Separator) {
+                    plan.removeLast();
                 }
-                filteredList.append(object);
+            }
+        }
 
+        const auto &numberKeys = [](QVector<ObjectKey> &keys) {
+            QHash<ObjectKey, int> counts;
+            for (auto &key : keys) {
+                const ObjectKey base{key.type, key.id, 0};
+                key.occurrence = counts[base]++;
             }
-            for (auto object : filteredList) {
-                object->setParent(q);
-                addObject(objects.size(), object);
+        };
+        numberKeys(plan);
+        QVector<ObjectKey> oldKeys;
+        oldKeys.reserve(records.size());
+        for (const auto &record : std::as_const(records)) {
+            oldKeys.append({record.type, record.id, 0});
+        }
+        numberKeys(oldKeys);
+
+        // Match the existing objects to the planned positions
+        QHash<ObjectKey, int> targets;
+        for (int i = 0; i < plan.size(); i++) {
+            targets.insert(plan[i], i);
+        }
+        QHash<QObject *, int> targetOf;
+        for (int i = oldKeys.size() - 1; i >= 0; i--) {
+            if (auto it = targets.find(oldKeys[i]); it != targets.end()) {
+                targetOf.insert(objects[i], it.value());
+            } else {
+                removeObject(i);
             }
         }
+
+        // The survivors in the longest increasing subsequence of targets stay in place, the
+        // others are moved once
+        const int survivorCount = objects.size();
+        QVector<int> tails; // length - 1 -> index of the smallest tail
+        QVector<int> predecessors(survivorCount, -1);
+        for (int i = 0; i < survivorCount; i++) {
+            const int target = targetOf.value(objects[i]);
+            auto it = std::lower_bound(tails.begin(), tails.end(), target, [&](int index, int value) {
+                return targetOf.value(objects[index]) < value;
+            });
+            if (it != tails.begin())
+                predecessors[i] = *(it - 1);
+            if (it == tails.end())
+                tails.append(i);
+            else
+                *it = i;
+        }
+        QVector<QObject *> placed(plan.size(), nullptr); // target -> object already in order
+        for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = predecessors[i]) {
+            placed[targetOf.value(objects[i])] = objects[i];
+        }
+        QVector<QObject *> movers(plan.size(), nullptr);
+        for (auto object : std::as_const(objects)) {
+            const int target = targetOf.value(object);
+            if (!placed[target])
+                movers[target] = object;
+        }
+        // The positions of the survivors, only the span shifted by a move is updated
+        QHash<QObject *, int> positions;
+        positions.reserve(objects.size());
+        for (int i = 0; i < objects.size(); i++) {
+            positions.insert(objects[i], i);
+        }
+        QObject *previous = nullptr; // the nearest preceding object already in order
+        for (int target = 0; target < plan.size(); target++) {
+            auto object = movers[target];
+            if (!object) {
+                if (placed[target])
+                    previous = placed[target];
+                continue;
+            }
+            // Insert behind the nearest preceding object which is already in order
+            int to = previous ? positions.value(previous) + 1 : 0;
+            const int from = positions.value(object);
+            if (from < to)
+                to--;
+            if (from != to) {
+                moveObject(from, to);
+                for (int i = qMin(from, to); i <= qMax(from, to); i++) {
+                    positions[objects[i]] = i;
+                }
+            }
+            placed[target] = object;
+            previous = object;
+        }
+
+        if (asynchronous) {
+            incubateObjects(plan, placed);
+            return;
+        }
+
+        // Create the missing objects, the consecutive ones are added as one range
+        int index = 0;
+        QObjectList run;
+        QVector<ObjectKey> runKeys;
+        const auto &flushRun = [&] {
+            addObjects(index, run, runKeys);
+            index += int(run.size());
+            run.clear();
+            runKeys.clear();
+        };
+        for (int target = 0; target < plan.size(); target++) {
+            if (placed[target]) {
+                flushRun();
+                index++;
+                continue;
+            }
+            auto object = createObject(plan[target]);
+            if (!object)
+                continue;
+            object->setParent(q);
+            run.append(object);
+            runKeys.append(plan[target]);
+        }
+        flushRun();
     }
-    void QuickActionInstantiatorPrivate::updateActionProperty(ActionProperty property) {
-        for (auto object : objects) {
-            auto action = qobject_cast<QQuickAction *>(object);
-            if (!action)
+    void QuickActionInstantiatorPrivate::incubateObjects(const QVector<ObjectKey> &plan, const QVector<QObject *> &placed) {
+        Q_Q(QuickActionInstantiator);
+        targetObjects = placed;
+        for (int target = 0; target < plan.size(); target++) {
+            if (targetObjects[target])
                 continue;
-            auto attachedInfoObject = qobject_cast<QuickActionInstantiatorAttachedType *>(
-                qmlAttachedPropertiesObject<QuickActionInstantiator>(object));
-            attachInfoObjectTo(attachedInfoObject->id(), object, property);
+            const auto &key = plan[target];
+            auto component = componentOf(key);
+
+            // Recycled objects are cheap, only the new ones are incubated
+            if (key.type != ActionLayoutEntry::Menu) {
+                if (auto object = context->d_func()->takeParkedObject(component)) {
+                    placeIncubatedObject(target, key, setupObject(key, object));
+                    continue;
+                }
+            }
+
+            // Without an incubation controller, e.g. without a window, the engine completes
+            // the incubator synchronously
+            auto incubator = new QuickActionObjectIncubator(this, key, target);
+            incubators.append(incubator);
+            incubationEngine = component->engine();
+            component->create(*incubator, component->creationContext());
         }
+        // The recycled and synchronously completed objects are added as ranges at once
+        flushIncubatedObjects();
+        if (incubators.isEmpty()) {
+            targetObjects.clear();
+            return;
+        }
+        if (!loading) {
+            loading = true;
+            emit q->loadingChanged();
+        }
+        if (!incubationTimer) {
+            // Spends the budget of this instantiator on top of what the controller of the engine
+            // schedules, without replacing the controller
+            incubationTimer = new QTimer(q);
+            incubationTimer->setInterval(16);
+            QObject::connect(incubationTimer, &QTimer::timeout, q, [this] {
+                if (incubators.isEmpty()) {
+                    incubationTimer->stop();
+                    return;
+                }
+                if (auto controller = incubationEngine ? incubationEngine->incubationController() : nullptr)
+                    controller->incubateFor(incubationBudget);
+            });
+        }
+        incubationTimer->start();
     }
-    QuickActionInstantiatorPrivate::Element
-        QuickActionInstantiatorPrivate::getElement(QObject *object) {
-        return static_cast<Element>(object->property(ELEMENT_PROPERTY).toInt());
+    void QuickActionInstantiatorPrivate::placeIncubatedObject(int target, const ObjectKey &key, QObject *object) {
+        Q_Q(QuickActionInstantiator);
+        object->setParent(q);
+        targetObjects[target] = object;
+        pendingTargets.insert(target, key);
+    }
+    void QuickActionInstantiatorPrivate::scheduleIncubatedObjects() {
+        Q_Q(QuickActionInstantiator);
+        if (flushScheduled)
+            return;
+        // The objects completing within one incubation slice are added together
+        flushScheduled = true;
+        QMetaObject::invokeMethod(q, [this] {
+            flushScheduled = false;
+            flushIncubatedObjects();
+        }, Qt::QueuedConnection);
+    }
+    void QuickActionInstantiatorPrivate::flushIncubatedObjects() {
+        if (pendingTargets.isEmpty())
+            return;
+        const auto pending = std::exchange(pendingTargets, {});
+        const auto targets = targetObjects;
+        int index = 0;
+        int first = 0;
+        QObjectList run;
+        QVector<ObjectKey> runKeys;
+        for (int target = 0; target < targets.size(); target++) {
+            auto object = targets[target];
+            if (!object)
+                continue;
+            if (auto it = pending.find(target); it != pending.end()) {
+                if (run.isEmpty())
+                    first = index;
+                run.append(object);
+                runKeys.append(it.value());
+            } else if (!run.isEmpty()) {
+                addObjects(first, run, runKeys);
+                run.clear();
+                runKeys.clear();
+            }
+            index++;
+        }
+        addObjects(first, run, runKeys);
+    }
+    void QuickActionInstantiatorPrivate::objectIncubated(QuickActionObjectIncubator *incubator) {
+        Q_Q(QuickActionInstantiator);
+        // Taken first, placing the object may update the layouts and cancel the incubation
+        if (!incubators.removeOne(incubator))
+            return;
+        retireIncubator(incubator);
+        if (incubator->isReady()) {
+            auto object = incubator->object();
+            auto component = componentOf(incubator->key);
+            if (incubator->key.type != ActionLayoutEntry::Menu) {
+                context->d_func()->adoptObject(component, object);
+            }
+            placeIncubatedObject(incubator->target, incubator->key, setupObject(incubator->key, object));
+        } else if (incubator->isError()) {
+            qmlWarning(q) << incubator->errors();
+        }
+
+        // The synchronous completions are added by incubateObjects()
+        if (!loading)
+            return;
+        if (!incubators.isEmpty()) {
+            scheduleIncubatedObjects();
+            return;
+        }
+        flushIncubatedObjects();
+        if (incubationTimer)
+            incubationTimer->stop();
+        targetObjects.clear();
+        loading = false;
+        emit q->loadingChanged();
+    }
+    void QuickActionInstantiatorPrivate::retireIncubator(QuickActionObjectIncubator *incubator) {
+        Q_Q(QuickActionInstantiator);
+        // An incubator cannot be deleted within its own callback, which may be on the stack
+        if (finishedIncubators.isEmpty()) {
+            QMetaObject::invokeMethod(q, [this] {
+                qDeleteAll(std::exchange(finishedIncubators, {}));
+            }, Qt::QueuedConnection);
+        }
+        finishedIncubators.append(incubator);
     }
-    void QuickActionInstantiatorPrivate::setElement(QObject *object, Element element) {
-        object->setProperty(ELEMENT_PROPERTY, element);
+    void QuickActionInstantiatorPrivate::cancelIncubation() {
+        Q_Q(QuickActionInstantiator);
+        // The objects completed so far are kept, the reconciliation may reuse them
+        flushIncubatedObjects();
+        if (incubators.isEmpty())
+            return;
+        // Take the list first, a cleared incubator reports the Null status which is ignored
+        const auto pending = std::exchange(incubators, {});
+        for (auto incubator : pending) {
+            incubator->clear();
+            retireIncubator(incubator);
+        }
+        if (incubationTimer)
+            incubationTimer->stop();
+        targetObjects.clear();
+        if (loading) {
+            loading = false;
+            emit q->loadingChanged();
+        }
     }
     void QuickActionInstantiatorPrivate::updateElement(Element element) {
-        QList<QPair<int, QObject *>> objectsToUpdate;
-        for (int i = 0; i < objects.size(); i++) {
-            auto object = objects[i];
-            auto elementType = getElement(object);
-            if (elementType != element)
-                continue;
-            objectsToUpdate.emplace_back(i, object);
+        ActionLayoutEntry::Type type;
+        switch (element) {
+            case Menu:
+                type = ActionLayoutEntry::Menu;
+                break;
+            case Separator:
+                type = ActionLayoutEntry::Separator;
+                break;
+            case Stretch:
+                type = ActionLayoutEntry::Stretch;
+                break;
+            default:
+                return;
         }
-        for (const auto &[i, object] : objectsToUpdate) {
+        for (int i = objects.size() - 1; i >= 0; i--) {
+            if (records[i].type != type)
+                continue;
+            QObject *object = nullptr;
             if (element == Menu) {
-                auto attachedInfoObject = qobject_cast<QuickActionInstantiatorAttachedType *>(qmlAttachedPropertiesObject<QuickActionInstantiator>(object));
-                modifyObject(i, createMenu(attachedInfoObject->id()));
+                object = menuComponent() ? createMenu(records[i].id) : nullptr;
             } else if (element == Separator) {
-                modifyObject(i, createSeparator());
+                object = createSeparator();
             } else if (element == Stretch) {
-                modifyObject(i, createStretch());
+                object = createStretch();
             }
+            if (object)
+                modifyObject(i, object);
+            else
+                removeObject(i);
         }
     }
 
+    QuickActionInstantiatorPrivate::~QuickActionInstantiatorPrivate() {
+        qDeleteAll(incubators);
+        qDeleteAll(finishedIncubators);
+    }
+
     QuickActionInstantiator::QuickActionInstantiator(QObject *parent) : QObject(parent), d_ptr(new QuickActionInstantiatorPrivate) {
         Q_D(QuickActionInstantiator);
         d->q_ptr = this;
@@ -424,6 +803,55 @@ namespace QAK {
         d->updateElement(QuickActionInstantiatorPrivate::Stretch);
         emit stretchComponentChanged();
     }
+    bool QuickActionInstantiator::isAsynchronous() const {
+        Q_D(const QuickActionInstantiator);
+        return d->asynchronous;
+    }
+    void QuickActionInstantiator::setAsynchronous(bool asynchronous) {
+        Q_D(QuickActionInstantiator);
+        if (d->asynchronous != asynchronous) {
+            d->asynchronous = asynchronous;
+            emit asynchronousChanged();
+        }
+    }
+    int QuickActionInstantiator::incubationBudget() const {
+        Q_D(const QuickActionInstantiator);
+        return d->incubationBudget;
+    }
+    void QuickActionInstantiator::setIncubationBudget(int msecs) {
+        Q_D(QuickActionInstantiator);
+        msecs = qMax(1, msecs);
+        if (d->incubationBudget != msecs) {
+            d->incubationBudget = msecs;
+            emit incubationBudgetChanged();
+        }
+    }
+    bool QuickActionInstantiator::lazySubmenus() const {
+        Q_D(const QuickActionInstantiator);
+        return d->lazySubmenus;
+    }
+    void QuickActionInstantiator::setLazySubmenus(bool lazy) {
+        Q_D(QuickActionInstantiator);
+        if (d->lazySubmenus != lazy) {
+            d->lazySubmenus = lazy;
+            emit lazySubmenusChanged();
+        }
+    }
+    bool QuickActionInstantiator::prefetchSubmenus() const {
+        Q_D(const QuickActionInstantiator);
+        return d->prefetchSubmenus;
+    }
+    void QuickActionInstantiator::setPrefetchSubmenus(bool prefetch) {
+        Q_D(QuickActionInstantiator);
+        if (d->prefetchSubmenus != prefetch) {
+            d->prefetchSubmenus = prefetch;
+            emit prefetchSubmenusChanged();
+        }
+    }
+    bool QuickActionInstantiator::isLoading() const {
+        Q_D(const QuickActionInstantiator);
+        return d->loading;
+    }
     void QuickActionInstantiator::forceUpdateLayouts() {
         Q_D(QuickActionInstantiator);
         d->updateLayouts();
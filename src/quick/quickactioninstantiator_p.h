@@ -24,6 +24,11 @@ namespace QAK {
         Q_PROPERTY(QQmlComponent *menuComponent READ menuComponent WRITE setMenuComponent RESET resetMenuComponent NOTIFY menuComponentChanged)
         Q_PROPERTY(QQmlComponent *separatorComponent READ separatorComponent WRITE setSeparatorComponent RESET resetSeparatorComponent NOTIFY separatorComponentChanged)
         Q_PROPERTY(QQmlComponent *stretchComponent READ stretchComponent WRITE setStretchComponent RESET resetStretchComponent NOTIFY stretchComponentChanged)
+        Q_PROPERTY(bool asynchronous READ isAsynchronous WRITE setAsynchronous NOTIFY asynchronousChanged)
+        Q_PROPERTY(int incubationBudget READ incubationBudget WRITE setIncubationBudget NOTIFY incubationBudgetChanged)
+        Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+        Q_PROPERTY(bool lazySubmenus READ lazySubmenus WRITE setLazySubmenus NOTIFY lazySubmenusChanged)
+        Q_PROPERTY(bool prefetchSubmenus READ prefetchSubmenus WRITE setPrefetchSubmenus NOTIFY prefetchSubmenusChanged)
     public:
         explicit QuickActionInstantiator(QObject *parent = nullptr);
         ~QuickActionInstantiator() override;
@@ -52,17 +57,50 @@ namespace QAK {
         void setStretchComponent(QQmlComponent *component);
         void resetStretchComponent();
 
+        // Creates the new objects with incremental incubators, the objects completing within one
+        // incubation slice are added together at their final positions
+        bool isAsynchronous() const;
+        void setAsynchronous(bool asynchronous);
+
+        // The time in milliseconds the instantiator spends on incubation every 16 ms while
+        // loading, on top of the incubation controller of the engine. An engine without a
+        // controller, e.g. without a window, creates the objects synchronously.
+        int incubationBudget() const;
+        void setIncubationBudget(int msecs);
+
+        bool isLoading() const;
+
+        // Populates the submenus when they are about to be shown for the first time, applies to
+        // the submenus created afterwards
+        bool lazySubmenus() const;
+        void setLazySubmenus(bool lazy);
+
+        // Populates the lazy submenus of this instantiator one by one while the event loop is idle
+        bool prefetchSubmenus() const;
+        void setPrefetchSubmenus(bool prefetch);
+
         Q_INVOKABLE void forceUpdateLayouts();
 
     signals:
         void idChanged();
         void objectAdded(int index, QObject *object);
+        // Surround the objectAdded() signals of a contiguous range created in one layout update,
+        // or completed within one incubation slice when asynchronous. countChanged() is emitted
+        // once after objectsAdded()
+        void objectsAboutToBeAdded(int first, int last);
+        void objectsAdded(int first, int last);
         void objectRemoved(int index, QObject *object);
+        void objectMoved(int from, int to, QObject *object);
         void contextChanged();
         void countChanged();
         void menuComponentChanged();
         void separatorComponentChanged();
         void stretchComponentChanged();
+        void asynchronousChanged();
+        void incubationBudgetChanged();
+        void loadingChanged();
+        void lazySubmenusChanged();
+        void prefetchSubmenusChanged();
 
     private:
         QScopedPointer<QuickActionInstantiatorPrivate> d_ptr;
@@ -4,19 +4,48 @@
 #include <QAKQuick/private/quickactioninstantiator_p.h>
 
 #include <QPointer>
+#include <QQmlEngine>
+#include <QTimer>
 
 #include <QAKCore/actionregistry.h>
 
 namespace QAK {
+    class QuickActionObjectIncubator;
+
     class QuickActionInstantiatorPrivate {
         Q_DECLARE_PUBLIC(QuickActionInstantiator)
     public:
+        ~QuickActionInstantiatorPrivate();
+
         QuickActionInstantiator *q_ptr;
 
         QString id;
 
         QPointer<QuickActionContext> context = nullptr;
+
+        // Identifies an object across layout updates, the occurrence tells apart the objects with
+        // the same type and id (e.g. separators).
+        struct ObjectKey {
+            ActionLayoutEntry::Type type;
+            QString id;
+            int occurrence;
+
+            inline bool operator==(const ObjectKey &other) const {
+                return type == other.type && occurrence == other.occurrence && id == other.id;
+            }
+            friend inline size_t qHash(const ObjectKey &key, size_t seed = 0) {
+                return qHashMulti(seed, int(key.type), key.id, key.occurrence);
+            }
+        };
+
+        // Side table of the objects, indexed like them
+        struct ObjectRecord {
+            ActionLayoutEntry::Type type; // Action, Menu, Separator or Stretch
+            QString id;
+        };
+
         QObjectList objects;
+        QVector<ObjectRecord> records;
 
         QPointer<QQmlComponent> menuComponent_override;
         bool isMenuComponentExplicitlySet{};
@@ -25,30 +54,66 @@ namespace QAK {
         QPointer<QQmlComponent> stretchComponent_override;
         bool isStretchComponentExplicitlySet{};
 
+        bool asynchronous{};
+        int incubationBudget = 5;
+        bool loading{};
+        QList<QuickActionObjectIncubator *> incubators;
+        QList<QuickActionObjectIncubator *> finishedIncubators; // deleted on the next event loop
+        QPointer<QQmlEngine> incubationEngine;
+        QTimer *incubationTimer{};
+        QVector<QObject *> targetObjects; // planned position -> object, while loading
+        QMap<int, ObjectKey> pendingTargets; // planned position -> key, placed but not added yet
+        bool flushScheduled{};
+
+        bool lazySubmenus{};
+        bool prefetchSubmenus{};
+        bool populated = true; // false until the menu of a lazy submenu is about to show
+        mutable QList<QPointer<QuickActionInstantiator>> prefetchQueue;
+        mutable QTimer *prefetchTimer{};
+
         QQmlComponent *menuComponent() const;
         QQmlComponent *separatorComponent() const;
         QQmlComponent *stretchComponent() const;
 
-        void addObject(int index, QObject *object);
+        void addObjects(int index, const QObjectList &newObjects, const QVector<ObjectKey> &keys);
         void removeObject(int index);
         void modifyObject(int index, QObject *object);
+        void moveObject(int from, int to);
+
+        // Separators, stretches and actions are recycled through the pool of the context
+        QObject *acquireObject(QQmlComponent *component) const;
+        void releaseObject(QObject *object) const;
 
-        QObjectList createObject(const ActionLayoutEntry &entry) const;
+        void planObjects(const ActionLayoutEntry &entry, QVector<ObjectKey> &plan) const;
+        QObject *createObject(const ObjectKey &key) const;
+        QQmlComponent *componentOf(const ObjectKey &key) const;
+        QObject *setupObject(const ObjectKey &key, QObject *object) const;
         QObject *createAction(const QString &actionId, QQmlComponent *component) const;
+        QObject *setupAction(const QString &actionId, QObject *object) const;
         QObject *createMenu(const QString &menuId) const;
+        QObject *setupMenu(const QString &menuId, QObject *menu) const;
         QObject *createSeparator() const;
         QObject *createStretch() const;
 
         void updateContext();
         void updateLayouts();
 
+        void incubateObjects(const QVector<ObjectKey> &plan, const QVector<QObject *> &placed);
+        void placeIncubatedObject(int target, const ObjectKey &key, QObject *object);
+        void scheduleIncubatedObjects();
+        void flushIncubatedObjects();
+        void objectIncubated(QuickActionObjectIncubator *incubator);
+        void retireIncubator(QuickActionObjectIncubator *incubator);
+        void cancelIncubation();
+
+        void populate();
+        void schedulePrefetch(QuickActionInstantiator *instantiator) const;
+
         enum ActionProperty { Text = 1, Icon = 2, Keymap = 4, All = Text | Icon | Keymap };
-        void updateActionProperty(ActionProperty property);
-        QuickActionInstantiatorAttachedType *attachInfoObjectTo(const QString &id, QObject *object, ActionProperty property) const;
+        QuickActionInstantiatorAttachedType *attachInfoObjectTo(const QString &id, QObject *object) const;
+        void initInfoObject(QuickActionInstantiatorAttachedType *attachedInfoObject, const QString &id) const;
 
         enum Element { Menu = 0x1000, Separator, Stretch };
-        static Element getElement(QObject *object);
-        static void setElement(QObject *object, Element element);
         void updateElement(Element element);
     };
 }
@@ -5,8 +5,11 @@
 
 #include <QAKQuick/private/quickactioninstantiator_p.h>
 #include <QAKQuick/private/quickactioninstantiator_p_p.h>
+#include <QAKQuick/private/quickactioninfoview_p.h>
 #include <QAKQuick/quickactioncontext.h>
+#include <QAKQuick/private/quickactioncontext_p.h>
 #include <QAKCore/actionextension.h>
+#include <QAKCore/actionregistry.h>
 
 namespace QAK {
     QuickActionInstantiatorAttachedType::QuickActionInstantiatorAttachedType(QObject *parent) : QObject(parent), d_ptr(new QuickActionInstantiatorAttachedTypePrivate) {
@@ -15,75 +18,51 @@ namespace QAK {
             connect(action, &QQuickAction::checkedChanged, this, &QuickActionInstantiatorAttachedType::iconChanged);
         }
     }
-    QuickActionInstantiatorAttachedType::~QuickActionInstantiatorAttachedType() = default;
-
-    void QuickActionInstantiatorAttachedType::init(const ActionItemInfo &info, QuickActionContext *context, int property) {
-        setId(info.id());
-        if (property & QuickActionInstantiatorPrivate::Text) {
-            auto text = info.text(true);
-            if (text.isEmpty()) {
-                text = info.text();
-            }
-            if (text.isEmpty()) {
-                text = info.id();
-            }
-            setText(text);
-            auto description = info.description(true);
-            if (description.isEmpty()) {
-                description = info.description();
-            }
-            setDescription(description);
+    QuickActionInstantiatorAttachedType::~QuickActionInstantiatorAttachedType() {
+        Q_D(QuickActionInstantiatorAttachedType);
+        if (d->context && d->view) {
+            d->context->d_func()->releaseInfoView(d->view);
         }
-        if (property & QuickActionInstantiatorPrivate::Icon) {
-            // TODO: theme
-            setActionIcon(context->registry()->actionIcon("", info.icon()));
+    }
+
+    void QuickActionInstantiatorAttachedType::init(const QString &id, QuickActionContext *context) {
+        Q_D(QuickActionInstantiatorAttachedType);
+        if (d->view && d->context == context && d->id == id) {
+            return;
         }
-        if (property & QuickActionInstantiatorPrivate::Keymap) {
-            setShortcuts(context->registry()->actionShortcuts(info.id()));
+        if (d->view) {
+            disconnect(d->view, nullptr, this, nullptr);
+            if (d->context)
+                d->context->d_func()->releaseInfoView(d->view);
         }
-        
-        // Convert ActionAttributeKey map to QVariantList format
-        QVariantList attributesList;
-        const auto infoAttributes = info.attributes();
-        for (auto it = infoAttributes.begin(); it != infoAttributes.end(); ++it) {
-            QVariantMap attributeMap;
-            attributeMap.insert("name", it.key().name);
-            attributeMap.insert("namespace", it.key().namespaceUri);
-            attributeMap.insert("value", it.value());
-            attributesList.append(attributeMap);
+        d->id = id;
+        d->context = context;
+        d->view = context ? context->d_func()->acquireInfoView(id) : nullptr;
+        if (d->view) {
+            connect(d->view, &QuickActionInfoView::textChanged, this, &QuickActionInstantiatorAttachedType::textChanged);
+            connect(d->view, &QuickActionInfoView::descriptionChanged, this, &QuickActionInstantiatorAttachedType::descriptionChanged);
+            connect(d->view, &QuickActionInfoView::iconChanged, this, &QuickActionInstantiatorAttachedType::iconChanged);
+            connect(d->view, &QuickActionInfoView::shortcutsChanged, this, &QuickActionInstantiatorAttachedType::shortcutsChanged);
+            connect(d->view, &QuickActionInfoView::attributesChanged, this, &QuickActionInstantiatorAttachedType::attributesChanged);
         }
-        setAttributes(attributesList);
+        emit textChanged();
+        emit descriptionChanged();
+        emit iconChanged();
+        emit shortcutsChanged();
+        emit attributesChanged();
     }
 
     QString QuickActionInstantiatorAttachedType::id() const {
         Q_D(const QuickActionInstantiatorAttachedType);
         return d->id;
     }
-    void QuickActionInstantiatorAttachedType::setId(const QString &id) {
-        Q_D(QuickActionInstantiatorAttachedType);
-        d->id = id;
-    }
     QString QuickActionInstantiatorAttachedType::text() const {
         Q_D(const QuickActionInstantiatorAttachedType);
-        return d->text;
-    }
-    void QuickActionInstantiatorAttachedType::setText(const QString &text) {
-        Q_D(QuickActionInstantiatorAttachedType);
-        if (d->text != text) {
-            d->text = text;
-            emit textChanged();
-        }
+        return d->view ? d->view->text : QString();
     }
     QString QuickActionInstantiatorAttachedType::description() const {
         Q_D(const QuickActionInstantiatorAttachedType);
-        return d->description;
-    }
-    void QuickActionInstantiatorAttachedType::setDescription(const QString &description) {
-        Q_D(QuickActionInstantiatorAttachedType);
-        if (d->description != description) {
-            d->description = description;
-            emit descriptionChanged();
-        }
+        return d->view ? d->view->description : QString();
     }
     QQuickIcon QuickActionInstantiatorAttachedType::icon() const {
         if (auto action = qobject_cast<QQuickAction *>(parent())) {
@@ -93,22 +72,16 @@ namespace QAK {
     }
     QList<QKeySequence> QuickActionInstantiatorAttachedType::shortcuts() const {
         Q_D(const QuickActionInstantiatorAttachedType);
-        return d->shortcuts;
+        return d->view ? d->view->shortcuts : QList<QKeySequence>();
     }
-    void QuickActionInstantiatorAttachedType::setShortcuts(const QList<QKeySequence> &shortcuts) {
+    void QuickActionInstantiatorAttachedType::recordUsage() {
         Q_D(QuickActionInstantiatorAttachedType);
-        if (d->shortcuts != shortcuts) {
-            d->shortcuts = shortcuts;
-            emit shortcutsChanged();
-        }
+        if (d->context && d->context->registry())
+            d->context->registry()->recordUsage(d->id);
     }
     QVariantList QuickActionInstantiatorAttachedType::attributes() const {
         Q_D(const QuickActionInstantiatorAttachedType);
-        return d->attributes;
-    }
-    void QuickActionInstantiatorAttachedType::setAttributes(const QVariantList &attributes) {
-        Q_D(QuickActionInstantiatorAttachedType);
-        d->attributes = attributes;
+        return d->view ? d->view->attributes : QVariantList();
     }
     QuickActionInstantiator *QuickActionInstantiatorAttachedType::instantiator() const {
         Q_D(const QuickActionInstantiatorAttachedType);
@@ -118,26 +91,11 @@ namespace QAK {
         Q_D(QuickActionInstantiatorAttachedType);
         d->instantiator = instantiator;
     }
-    void QuickActionInstantiatorAttachedType::setActionIcon(const ActionIcon &actionIcon) {
-        Q_D(QuickActionInstantiatorAttachedType);
-        for (int i = 0; i < 4; i++) {
-            QQuickIcon icon;
-            bool enabledFlag = i & 1;
-            bool checkedFlag = i & 2;
-            icon.setSource(actionIcon.url(enabledFlag, checkedFlag));
-            auto color = QColor::fromString(actionIcon.currentColor());
-            icon.setColor(color);
-            d->icons[i] = icon;
-            emit iconChanged();
-        }
-        for (auto &icon : d->icons) {
-            if (icon.source().isEmpty()) {
-                icon = d->icons[1];
-            }
-        }
-    }
     QQuickIcon QuickActionInstantiatorAttachedType::selectIconByStatus(bool enabled, bool checked) const {
         Q_D(const QuickActionInstantiatorAttachedType);
+        if (!d->view) {
+            return {};
+        }
         int flag = 0;
         if (enabled) {
             flag |= 1;
@@ -145,7 +103,7 @@ namespace QAK {
         if (checked) {
             flag |= 2;
         }
-        return d->icons[flag];
+        return d->view->icons[flag];
     }
 }
 
@@ -8,10 +8,6 @@ class QQuickIcon;
 
 namespace QAK {
 
-    class ActionIcon;
-
-    class ActionItemInfo;
-
     class QuickActionContext;
 
     class QuickActionInstantiator;
@@ -28,44 +24,42 @@ namespace QAK {
         Q_PROPERTY(QString description READ description NOTIFY descriptionChanged)
         Q_PROPERTY(QQuickIcon icon READ icon NOTIFY iconChanged)
         Q_PROPERTY(QList<QKeySequence> shortcuts READ shortcuts NOTIFY shortcutsChanged)
-        Q_PROPERTY(QVariantList attributes READ attributes CONSTANT)
+        Q_PROPERTY(QVariantList attributes READ attributes NOTIFY attributesChanged)
         Q_PROPERTY(QuickActionInstantiator *instantiator READ instantiator CONSTANT)
 
     public:
         explicit QuickActionInstantiatorAttachedType(QObject *parent = nullptr);
         ~QuickActionInstantiatorAttachedType() override;
 
-        void init(const ActionItemInfo &info, QuickActionContext *context, int);
+        // Binds the object to the shared info view of id in context
+        void init(const QString &id, QuickActionContext *context);
 
         QString id() const;
-        void setId(const QString &id);
 
         QString text() const;
-        void setText(const QString &text);
 
         QString description() const;
-        void setDescription(const QString &description);
 
         QQuickIcon icon() const;
 
         QList<QKeySequence> shortcuts() const;
-        void setShortcuts(const QList<QKeySequence> &shortcuts);
 
         QVariantList attributes() const;
-        void setAttributes(const QVariantList &attributes);
 
         QuickActionInstantiator *instantiator() const;
         void setInstantiator(QuickActionInstantiator *instantiator);
 
-        void setActionIcon(const ActionIcon &actionIcon);
-
         Q_INVOKABLE QQuickIcon selectIconByStatus(bool enabled, bool checked) const;
 
+        // Records a trigger of the current id in the registry of the context
+        void recordUsage();
+
     signals:
         void textChanged();
         void descriptionChanged();
         void iconChanged();
         void shortcutsChanged();
+        void attributesChanged();
 
     private:
         QScopedPointer<QuickActionInstantiatorAttachedTypePrivate> d_ptr;
@@ -2,7 +2,9 @@
 #define QUICKACTIONINSTANTIATORATTACHEDTYPE_P_P_H
 
 #include <QAKQuick/private/quickactioninstantiatorattachedtype_p.h>
+#include <QAKQuick/private/quickactioninfoview_p.h>
 
+#include <QPointer>
 #include <QVariant>
 #include <QUrl>
 #include <QtQuickTemplates2/private//qquickaction_p.h>
@@ -11,14 +13,9 @@ namespace QAK {
     class QuickActionInstantiatorAttachedTypePrivate {
     public:
         QString id;
-        QString text;
-        QString description;
-        QUrl iconSource;
-        QList<QKeySequence> shortcuts;
-        QVariantList attributes;
-        QuickActionInstantiator *instantiator;
-
-        QQuickIcon icons[4];
+        QuickActionInstantiator *instantiator{};
+        QPointer<QuickActionContext> context;
+        QPointer<QuickActionInfoView> view; // shared with the other objects of the id
     };
 }
 
@@ -0,0 +1,238 @@
+#include "quickactionlayoutslistmodel_p.h"
+#include "quickactionlayoutslistmodel_p_p.h"
+
+#include <utility>
+
+#include <QKeySequence>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKQuick/quickactioncontext.h>
+#include <QAKQuick/private/quickactioncontext_p.h>
+#include <QAKQuick/private/quickactioninfoview_p.h>
+
+namespace QAK {
+
+    void QuickActionLayoutsListModelPrivate::rebuild() {
+        Q_Q(QuickActionLayoutsListModel);
+        QVector<Row> newRows;
+        if (context && context->registry()) {
+            auto info = context->registry()->actionInfo(id);
+            if (!info.isNull()) {
+                const auto entries = context->registry()->layouts().flattenedChildren(info.id());
+                newRows.reserve(entries.size());
+                for (const auto &entry : entries) {
+                    newRows.append({entry.type(), entry.id()});
+                }
+            }
+        }
+
+        // Keep the views of the ids still shown, so that they are not resolved again
+        auto oldViews = std::exchange(views, {});
+        if (context) {
+            for (const auto &row : std::as_const(newRows)) {
+                if (row.type != ActionLayoutEntry::Action && row.type != ActionLayoutEntry::Menu)
+                    continue;
+                if (views.contains(row.id))
+                    continue;
+                auto view = oldViews.take(row.id);
+                views.insert(row.id, view ? view : acquireView(row.id));
+            }
+        }
+
+        // Replace only the rows between the common head and tail, a patch of the node usually
+        // inserts or removes a few entries and the delegates of the other rows are kept
+        const auto sameRow = [](const Row &a, const Row &b) {
+            return a.type == b.type && a.id == b.id;
+        };
+        const int oldCount = int(rows.size());
+        const int newCount = int(newRows.size());
+        int head = 0;
+        while (head < oldCount && head < newCount && sameRow(rows.at(head), newRows.at(head))) {
+            head++;
+        }
+        int tail = 0;
+        while (tail < oldCount - head && tail < newCount - head &&
+               sameRow(rows.at(oldCount - 1 - tail), newRows.at(newCount - 1 - tail))) {
+            tail++;
+        }
+        if (head + tail < oldCount) {
+            q->beginRemoveRows({}, head, oldCount - tail - 1);
+            rows.remove(head, oldCount - tail - head);
+            q->endRemoveRows();
+        }
+        if (head + tail < newCount) {
+            q->beginInsertRows({}, head, newCount - tail - 1);
+            rows = newRows;
+            q->endInsertRows();
+        }
+        if (head + tail < oldCount || head + tail < newCount) {
+            rowsById.clear();
+            for (int i = 0; i < rows.size(); i++) {
+                if (!rows[i].id.isEmpty())
+                    rowsById.insert(rows[i].id, i);
+            }
+        }
+        releaseViews(oldViews);
+        if (oldCount != newCount)
+            emit q->countChanged();
+    }
+
+    QuickActionInfoView *QuickActionLayoutsListModelPrivate::acquireView(const QString &id) {
+        Q_Q(QuickActionLayoutsListModel);
+        auto view = context->d_func()->acquireInfoView(id);
+        QObject::connect(view, &QuickActionInfoView::textChanged, q, [this, id] {
+            notifyRows(id, {QuickActionLayoutsListModel::TextRole});
+        });
+        QObject::connect(view, &QuickActionInfoView::iconChanged, q, [this, id] {
+            notifyRows(id, {QuickActionLayoutsListModel::IconRole});
+        });
+        QObject::connect(view, &QuickActionInfoView::shortcutsChanged, q, [this, id] {
+            notifyRows(id, {QuickActionLayoutsListModel::ShortcutRole});
+        });
+        return view;
+    }
+
+    void QuickActionLayoutsListModelPrivate::releaseViews(const QHash<QString, QuickActionInfoView *> &oldViews) {
+        Q_Q(QuickActionLayoutsListModel);
+        if (!context)
+            return; // the views were destroyed with the context
+        for (auto view : oldViews) {
+            QObject::disconnect(view, nullptr, q, nullptr);
+            context->d_func()->releaseInfoView(view);
+        }
+    }
+
+    void QuickActionLayoutsListModelPrivate::notifyRows(const QString &id, const QList<int> &roles) {
+        Q_Q(QuickActionLayoutsListModel);
+        for (auto it = rowsById.constFind(id); it != rowsById.constEnd() && it.key() == id; ++it) {
+            const auto index = q->index(it.value());
+            emit q->dataChanged(index, index, roles);
+        }
+    }
+
+    QuickActionLayoutsListModel::QuickActionLayoutsListModel(QObject *parent)
+        : QAbstractListModel(parent), d_ptr(new QuickActionLayoutsListModelPrivate) {
+        Q_D(QuickActionLayoutsListModel);
+        d->q_ptr = this;
+    }
+
+    QuickActionLayoutsListModel::~QuickActionLayoutsListModel() {
+        Q_D(QuickActionLayoutsListModel);
+        d->releaseViews(std::exchange(d->views, {}));
+    }
+
+    QString QuickActionLayoutsListModel::id() const {
+        Q_D(const QuickActionLayoutsListModel);
+        return d->id;
+    }
+
+    void QuickActionLayoutsListModel::setId(const QString &id) {
+        Q_D(QuickActionLayoutsListModel);
+        if (d->id == id)
+            return;
+        d->id = id;
+        d->rebuild();
+        emit idChanged();
+    }
+
+    QuickActionContext *QuickActionLayoutsListModel::context() const {
+        Q_D(const QuickActionLayoutsListModel);
+        return d->context;
+    }
+
+    void QuickActionLayoutsListModel::setContext(QuickActionContext *context) {
+        Q_D(QuickActionLayoutsListModel);
+        if (d->context == context)
+            return;
+        if (d->context) {
+            disconnect(d->context, nullptr, this, nullptr);
+            // The views belong to the old context
+            d->releaseViews(std::exchange(d->views, {}));
+        }
+        d->context = context;
+        if (d->context) {
+            connect(d->context, &QuickActionContext::layoutsAboutToUpdate, this, [d] {
+                d->rebuild();
+            });
+            connect(d->context, &QObject::destroyed, this, [this, d] {
+                // The views are destroyed with the context, drop them without releasing
+                d->views.clear();
+                const bool hadRows = !d->rows.isEmpty();
+                beginResetModel();
+                d->rows.clear();
+                d->rowsById.clear();
+                endResetModel();
+                if (hadRows)
+                    emit countChanged();
+            });
+        }
+        d->rebuild();
+        emit contextChanged();
+    }
+
+    bool QuickActionLayoutsListModel::isActionEnabled(const QString &id) const {
+        Q_D(const QuickActionLayoutsListModel);
+        return !d->disabledIds.contains(id);
+    }
+
+    void QuickActionLayoutsListModel::setActionEnabled(const QString &id, bool enabled) {
+        Q_D(QuickActionLayoutsListModel);
+        if (enabled == !d->disabledIds.contains(id))
+            return;
+        if (enabled)
+            d->disabledIds.remove(id);
+        else
+            d->disabledIds.insert(id);
+        d->notifyRows(id, {EnabledRole, IconRole});
+    }
+
+    int QuickActionLayoutsListModel::rowCount(const QModelIndex &parent) const {
+        Q_D(const QuickActionLayoutsListModel);
+        if (parent.isValid())
+            return 0;
+        return int(d->rows.size());
+    }
+
+    QVariant QuickActionLayoutsListModel::data(const QModelIndex &index, int role) const {
+        Q_D(const QuickActionLayoutsListModel);
+        if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+            return {};
+        const auto &row = d->rows.at(index.row());
+        const auto view = d->views.value(row.id);
+        switch (role) {
+            case IdRole:
+                return row.id;
+            case TypeRole:
+                return int(row.type);
+            case Qt::DisplayRole:
+            case TextRole:
+                return view ? view->text : QString();
+            case IconRole:
+                if (!view)
+                    return {};
+                return QVariant::fromValue(view->icons[d->disabledIds.contains(row.id) ? 0 : 1]);
+            case ShortcutRole:
+                if (!view || view->shortcuts.isEmpty())
+                    return QString();
+                return view->shortcuts.first().toString(QKeySequence::NativeText);
+            case EnabledRole:
+                return !d->disabledIds.contains(row.id);
+            default:
+                return {};
+        }
+    }
+
+    QHash<int, QByteArray> QuickActionLayoutsListModel::roleNames() const {
+        return {
+            {IdRole,       "id"      },
+            {TypeRole,     "type"    },
+            {TextRole,     "text"    },
+            {IconRole,     "icon"    },
+            {ShortcutRole, "shortcut"},
+            {EnabledRole,  "enabled" },
+        };
+    }
+
+}
+
+#include "moc_quickactionlayoutslistmodel_p.cpp"
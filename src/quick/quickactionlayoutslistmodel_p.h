@@ -0,0 +1,73 @@
+#ifndef QUICKACTIONLAYOUTSLISTMODEL_P_H
+#define QUICKACTIONLAYOUTSLISTMODEL_P_H
+
+#include <QAbstractListModel>
+#include <qqmlintegration.h>
+
+#include <QAKCore/actionextension.h>
+#include <QAKQuick/qakquickglobal.h>
+
+namespace QAK {
+
+    class QuickActionContext;
+
+    class QuickActionLayoutsListModelPrivate;
+
+    // Flattens the children of one layout node into rows, the groups are expanded and the
+    // separators collapsed like in the instantiators, so that a virtualized view only creates
+    // the delegates of the visible rows
+    class QAK_QUICK_EXPORT QuickActionLayoutsListModel : public QAbstractListModel {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(QuickActionLayoutsListModel)
+        QML_NAMED_ELEMENT(ActionLayoutsListModel)
+        Q_PROPERTY(QString actionId READ id WRITE setId NOTIFY idChanged)
+        Q_PROPERTY(QuickActionContext *context READ context WRITE setContext NOTIFY contextChanged)
+        Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    public:
+        enum Type {
+            Action = ActionLayoutEntry::Action,
+            Menu = ActionLayoutEntry::Menu,
+            Separator = ActionLayoutEntry::Separator,
+            Stretch = ActionLayoutEntry::Stretch,
+        };
+        Q_ENUM(Type)
+
+        enum Role {
+            IdRole = Qt::UserRole + 1,
+            TypeRole,
+            TextRole,
+            IconRole,
+            ShortcutRole,
+            EnabledRole,
+        };
+        Q_ENUM(Role)
+
+        explicit QuickActionLayoutsListModel(QObject *parent = nullptr);
+        ~QuickActionLayoutsListModel() override;
+
+        QString id() const;
+        void setId(const QString &id);
+
+        QuickActionContext *context() const;
+        void setContext(QuickActionContext *context);
+
+        // The actions are enabled unless disabled here, the rows have no action object to ask
+        Q_INVOKABLE bool isActionEnabled(const QString &id) const;
+        Q_INVOKABLE void setActionEnabled(const QString &id, bool enabled);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        QHash<int, QByteArray> roleNames() const override;
+
+    signals:
+        void idChanged();
+        void contextChanged();
+        void countChanged();
+
+    private:
+        QScopedPointer<QuickActionLayoutsListModelPrivate> d_ptr;
+    };
+
+}
+
+#endif //QUICKACTIONLAYOUTSLISTMODEL_P_H
@@ -0,0 +1,39 @@
+#ifndef QUICKACTIONLAYOUTSLISTMODEL_P_P_H
+#define QUICKACTIONLAYOUTSLISTMODEL_P_P_H
+
+#include <QAKQuick/private/quickactionlayoutslistmodel_p.h>
+
+#include <QPointer>
+#include <QSet>
+
+namespace QAK {
+
+    class QuickActionInfoView;
+
+    class QuickActionLayoutsListModelPrivate {
+        Q_DECLARE_PUBLIC(QuickActionLayoutsListModel)
+    public:
+        QuickActionLayoutsListModel *q_ptr;
+
+        QString id;
+        QPointer<QuickActionContext> context;
+
+        struct Row {
+            ActionLayoutEntry::Type type;
+            QString id;
+        };
+        QVector<Row> rows;
+        QMultiHash<QString, int> rowsById;
+
+        // The shared info views of the action and menu rows, one reference per id
+        QHash<QString, QuickActionInfoView *> views;
+        QSet<QString> disabledIds;
+
+        void rebuild();
+        QuickActionInfoView *acquireView(const QString &id);
+        void releaseViews(const QHash<QString, QuickActionInfoView *> &oldViews);
+        void notifyRows(const QString &id, const QList<int> &roles);
+    };
+}
+
+#endif //QUICKACTIONLAYOUTSLISTMODEL_P_P_H
@@ -6,6 +6,8 @@
 #include <QtQuickTemplates2/private/qquickmenu_p.h>
 #include <QtQuick/QQuickItem>
 
+#include <QAKQuick/private/quickmenuadapter_p.h>
+
 namespace QAK {
 
     void QuickMenuActionInstantiator::addToMenu(int index, QObject *object) {
@@ -13,20 +15,21 @@ namespace QAK {
         if (!menu) {
             return;
         }
-        if (auto action = qobject_cast<QQuickAction *>(object)) {
-            QMetaObject::invokeMethod(menu, "insertAction", index, action);
-        } else if (auto submenu = qobject_cast<QQuickMenu *>(object)) {
-            QMetaObject::invokeMethod(menu, "insertMenu", index, submenu);
-        } else if (auto item = qobject_cast<QQuickItem *>(object)) {
-            QMetaObject::invokeMethod(menu, "insertItem", index, item);
-        } else {
-            qmlWarning(this) << "QAK::QuickMenuActionInstantiator: Unknown object type"
-                          << object->metaObject()->className();
-            auto placeholderItem = new QQuickItem;
+        const auto adapter = QuickMenuAdapter::of(menu);
+        if (adapter->insert(menu, index, object)) {
+            return;
+        }
+        qmlWarning(this) << "QAK::QuickMenuActionInstantiator: Unknown object type"
+                         << object->metaObject()->className();
+        // Keep the indexes of the objects and items the same, reuse the placeholder of the object
+        // if it was inserted before
+        auto placeholderItem = object->findChild<QQuickItem *>(QString(), Qt::FindDirectChildrenOnly);
+        if (!placeholderItem) {
+            placeholderItem = new QQuickItem;
             placeholderItem->setParent(object);
             placeholderItem->setVisible(false);
-            QMetaObject::invokeMethod(menu, "insertItem", index, placeholderItem);
         }
+        adapter->insert(menu, index, placeholderItem);
     }
 
     void QuickMenuActionInstantiator::removeFromMenu(int index, QObject *object) {
@@ -34,19 +37,19 @@ namespace QAK {
         if (!menu) {
             return;
         }
-        if (auto action = qobject_cast<QQuickAction *>(object)) {
-            QMetaObject::invokeMethod(menu, "removeAction", action);
-        } else if (auto submenu = qobject_cast<QQuickMenu *>(object)) {
-            QMetaObject::invokeMethod(menu, "removeMenu", submenu);
-        } else if (auto item = qobject_cast<QQuickItem *>(object)) {
-            QMetaObject::invokeMethod(menu, "removeItem", item);
-        } else {
-            qmlWarning(this) << "QAK::QuickActionInstantiator: Unknown object type"
-                          << object->metaObject()->className();
-            QMetaObject::invokeMethod(menu, "takeItem", index);
+        QuickMenuAdapter::of(menu)->take(menu, index, object);
+    }
+
+    void QuickMenuActionInstantiator::moveInMenu(int from, int to, QObject *object) {
+        Q_UNUSED(object)
+        auto menu = target();
+        if (!menu) {
+            return;
         }
+        // Every object owns exactly one item of the container, so the indexes are the same
+        QuickMenuAdapter::of(menu)->move(menu, from, to);
     }
-    
+
     QuickMenuActionInstantiator::QuickMenuActionInstantiator(QObject *parent)
         : AbstractQuickMenuActionInstantiator(parent) {
     }
@@ -0,0 +1,216 @@
+#include "quickmenuadapter_p.h"
+
+#include <QHash>
+#include <QMetaMethod>
+#include <QMutex>
+#include <QtQuickTemplates2/private/qquickaction_p.h>
+#include <QtQuickTemplates2/private/qquickcontainer_p.h>
+#include <QtQuickTemplates2/private/qquickmenu_p.h>
+#include <QtQuickTemplates2/private/qquickmenubar_p.h>
+
+namespace QAK {
+
+    int QuickMenuAdapter::insertRange(QObject *container, int index, const QObjectList &objects,
+                                      int from) const {
+        int count = 0;
+        for (int i = from; i < objects.size(); i++) {
+            if (!insert(container, index + count, objects.at(i)))
+                break;
+            count++;
+        }
+        return count;
+    }
+
+    namespace {
+
+        class QuickMenuBarAdapter : public QuickMenuAdapter {
+        public:
+            bool insert(QObject *container, int index, QObject *object) const override {
+                auto menu = qobject_cast<QQuickMenu *>(object);
+                if (!menu)
+                    return false;
+                static_cast<QQuickMenuBar *>(container)->insertMenu(index, menu);
+                return true;
+            }
+            int insertRange(QObject *container, int index, const QObjectList &objects,
+                            int from) const override {
+                const auto menuBar = static_cast<QQuickMenuBar *>(container);
+                int count = 0;
+                for (int i = from; i < objects.size(); i++) {
+                    auto menu = qobject_cast<QQuickMenu *>(objects.at(i));
+                    if (!menu)
+                        break;
+                    menuBar->insertMenu(index + count, menu);
+                    count++;
+                }
+                return count;
+            }
+            void take(QObject *container, int index, QObject *object) const override {
+                Q_UNUSED(object)
+                static_cast<QQuickMenuBar *>(container)->takeMenu(index);
+            }
+            void move(QObject *container, int from, int to) const override {
+                static_cast<QQuickMenuBar *>(container)->moveItem(from, to);
+            }
+        };
+
+        class QuickMenuAdapterImpl : public QuickMenuAdapter {
+        public:
+            bool insert(QObject *container, int index, QObject *object) const override {
+                return insertInto(static_cast<QQuickMenu *>(container), index, object);
+            }
+            int insertRange(QObject *container, int index, const QObjectList &objects,
+                            int from) const override {
+                const auto menu = static_cast<QQuickMenu *>(container);
+                int count = 0;
+                for (int i = from; i < objects.size(); i++) {
+                    if (!insertInto(menu, index + count, objects.at(i)))
+                        break;
+                    count++;
+                }
+                return count;
+            }
+            void take(QObject *container, int index, QObject *object) const override {
+                auto menu = static_cast<QQuickMenu *>(container);
+                if (qobject_cast<QQuickAction *>(object)) {
+                    menu->takeAction(index);
+                } else if (qobject_cast<QQuickMenu *>(object)) {
+                    menu->takeMenu(index);
+                } else {
+                    menu->takeItem(index);
+                }
+            }
+            void move(QObject *container, int from, int to) const override {
+                static_cast<QQuickMenu *>(container)->moveItem(from, to);
+            }
+
+        private:
+            static bool insertInto(QQuickMenu *menu, int index, QObject *object) {
+                if (auto action = qobject_cast<QQuickAction *>(object)) {
+                    menu->insertAction(index, action);
+                } else if (auto submenu = qobject_cast<QQuickMenu *>(object)) {
+                    menu->insertMenu(index, submenu);
+                } else if (auto item = qobject_cast<QQuickItem *>(object)) {
+                    menu->insertItem(index, item);
+                } else {
+                    return false;
+                }
+                return true;
+            }
+        };
+
+        class QuickContainerAdapter : public QuickMenuAdapter {
+        public:
+            bool insert(QObject *container, int index, QObject *object) const override {
+                auto item = qobject_cast<QQuickItem *>(object);
+                if (!item)
+                    return false;
+                static_cast<QQuickContainer *>(container)->insertItem(index, item);
+                return true;
+            }
+            int insertRange(QObject *container, int index, const QObjectList &objects,
+                            int from) const override {
+                const auto quickContainer = static_cast<QQuickContainer *>(container);
+                int count = 0;
+                for (int i = from; i < objects.size(); i++) {
+                    auto item = qobject_cast<QQuickItem *>(objects.at(i));
+                    if (!item)
+                        break;
+                    quickContainer->insertItem(index + count, item);
+                    count++;
+                }
+                return count;
+            }
+            void take(QObject *container, int index, QObject *object) const override {
+                Q_UNUSED(object)
+                static_cast<QQuickContainer *>(container)->takeItem(index);
+            }
+            void move(QObject *container, int from, int to) const override {
+                static_cast<QQuickContainer *>(container)->moveItem(from, to);
+            }
+        };
+
+        // For the other types, the item methods are resolved once per metaobject
+        class QuickMetaMethodAdapter : public QuickMenuAdapter {
+        public:
+            struct Methods {
+                QByteArray className; // checked on every hit, the address may be reused
+                QMetaMethod insertItem;
+                QMetaMethod takeItem;
+                QMetaMethod moveItem;
+            };
+
+            bool insert(QObject *container, int index, QObject *object) const override {
+                auto item = qobject_cast<QQuickItem *>(object);
+                const auto methods = methodsOf(container);
+                if (!item || !methods.insertItem.isValid())
+                    return false;
+                methods.insertItem.invoke(container, index, item);
+                return true;
+            }
+            int insertRange(QObject *container, int index, const QObjectList &objects,
+                            int from) const override {
+                const auto methods = methodsOf(container);
+                if (!methods.insertItem.isValid())
+                    return 0;
+                int count = 0;
+                for (int i = from; i < objects.size(); i++) {
+                    auto item = qobject_cast<QQuickItem *>(objects.at(i));
+                    if (!item)
+                        break;
+                    methods.insertItem.invoke(container, index + count, item);
+                    count++;
+                }
+                return count;
+            }
+            void take(QObject *container, int index, QObject *object) const override {
+                Q_UNUSED(object)
+                if (const auto methods = methodsOf(container); methods.takeItem.isValid())
+                    methods.takeItem.invoke(container, index);
+            }
+            void move(QObject *container, int from, int to) const override {
+                if (const auto methods = methodsOf(container); methods.moveItem.isValid())
+                    methods.moveItem.invoke(container, from, to);
+            }
+
+        private:
+            static Methods methodsOf(const QObject *container) {
+                static QBasicMutex mutex;
+                static QHash<const QMetaObject *, Methods> cache;
+
+                const auto metaObject = container->metaObject();
+                QMutexLocker locker(&mutex);
+                auto it = cache.find(metaObject);
+                if (it == cache.end() || it->className != metaObject->className()) {
+                    const auto method = [metaObject](const char *signature) {
+                        return metaObject->method(metaObject->indexOfMethod(signature));
+                    };
+                    it = cache.insert(metaObject, {
+                                                      metaObject->className(),
+                                                      method("insertItem(int,QQuickItem*)"),
+                                                      method("takeItem(int)"),
+                                                      method("moveItem(int,int)"),
+                                                  });
+                }
+                return it.value();
+            }
+        };
+
+    }
+
+    const QuickMenuAdapter *QuickMenuAdapter::of(const QObject *container) {
+        static const QuickMenuBarAdapter menuBarAdapter;
+        static const QuickMenuAdapterImpl menuAdapter;
+        static const QuickContainerAdapter containerAdapter;
+        static const QuickMetaMethodAdapter metaMethodAdapter;
+
+        if (qobject_cast<const QQuickMenuBar *>(container))
+            return &menuBarAdapter;
+        if (qobject_cast<const QQuickMenu *>(container))
+            return &menuAdapter;
+        if (qobject_cast<const QQuickContainer *>(container))
+            return &containerAdapter;
+        return &metaMethodAdapter;
+    }
+
+}
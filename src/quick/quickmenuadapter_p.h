@@ -0,0 +1,28 @@
+#ifndef QUICKMENUADAPTER_P_H
+#define QUICKMENUADAPTER_P_H
+
+#include <QObject>
+
+namespace QAK {
+
+    // Inserts, takes and moves the instantiated objects of a menu container with direct calls,
+    // the adapter is picked by the type of the container and holds no per-container state
+    class QuickMenuAdapter {
+    public:
+        virtual ~QuickMenuAdapter() = default;
+
+        // Returns false if the container cannot hold the object
+        virtual bool insert(QObject *container, int index, QObject *object) const = 0;
+        // Inserts objects[from], objects[from + 1]... at index until one cannot be held, returns
+        // the number inserted. The container is resolved once for the whole range.
+        virtual int insertRange(QObject *container, int index, const QObjectList &objects, int from) const;
+        // Takes the object without destroying it, the instantiator decides whether it is recycled
+        virtual void take(QObject *container, int index, QObject *object) const = 0;
+        virtual void move(QObject *container, int from, int to) const = 0;
+
+        static const QuickMenuAdapter *of(const QObject *container);
+    };
+
+}
+
+#endif //QUICKMENUADAPTER_P_H
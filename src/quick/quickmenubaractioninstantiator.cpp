@@ -5,6 +5,9 @@
 #include <QtQuickTemplates2/private/qquickaction_p.h>
 #include <QtQuickTemplates2/private/qquickmenu_p.h>
 #include <QtQuick/QQuickItem>
+#include <QQmlComponent>
+
+#include <QAKQuick/private/quickmenuadapter_p.h>
 
 namespace QAK {
 
@@ -13,15 +16,21 @@ namespace QAK {
         if (!menuBar) {
             return;
         }
-        if (auto submenu = qobject_cast<QQuickMenu *>(object)) {
-            QMetaObject::invokeMethod(menuBar, "insertMenu", index, submenu);
-        } else {
-            qmlWarning(this) << "QAK::QuickMenuBarActionInstantiator: Unknown object type"
-                          << object->metaObject()->className();
-            auto placeholderMenu = menuComponent()->create(menuComponent()->creationContext());
-            placeholderMenu->setParent(object);
-            QMetaObject::invokeMethod(menuBar, "insertMenu", index, placeholderMenu);
+        const auto adapter = QuickMenuAdapter::of(menuBar);
+        if (adapter->insert(menuBar, index, object)) {
+            return;
+        }
+        qmlWarning(this) << "QAK::QuickMenuBarActionInstantiator: Unknown object type"
+                         << object->metaObject()->className();
+        // The placeholder is created once per object and reused when it is inserted again
+        auto placeholderMenu = object->findChild<QQuickMenu *>(QString(), Qt::FindDirectChildrenOnly);
+        if (!placeholderMenu && menuComponent()) {
+            placeholderMenu = qobject_cast<QQuickMenu *>(menuComponent()->create(menuComponent()->creationContext()));
+            if (placeholderMenu)
+                placeholderMenu->setParent(object);
         }
+        if (placeholderMenu)
+            adapter->insert(menuBar, index, placeholderMenu);
     }
 
     void QuickMenuBarActionInstantiator::removeFromMenu(int index, QObject *object) {
@@ -29,15 +38,19 @@ namespace QAK {
         if (!menuBar) {
             return;
         }
-        if (auto submenu = qobject_cast<QQuickMenu *>(object)) {
-            QMetaObject::invokeMethod(menuBar, "removeMenu", submenu);
-        } else {
-            qmlWarning(this) << "QAK::QuickMenuBarActionInstantiator: Unknown object type"
-                          << object->metaObject()->className();
-            QMetaObject::invokeMethod(menuBar, "takeMenu", index);
+        QuickMenuAdapter::of(menuBar)->take(menuBar, index, object);
+    }
+
+    void QuickMenuBarActionInstantiator::moveInMenu(int from, int to, QObject *object) {
+        Q_UNUSED(object)
+        auto menuBar = target();
+        if (!menuBar) {
+            return;
         }
+        // Every object owns exactly one item of the container, so the indexes are the same
+        QuickMenuAdapter::of(menuBar)->move(menuBar, from, to);
     }
-    
+
     QuickMenuBarActionInstantiator::QuickMenuBarActionInstantiator(QObject *parent)
         : AbstractQuickMenuActionInstantiator(parent) {
     }
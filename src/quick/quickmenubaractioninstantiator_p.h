@@ -15,6 +15,7 @@ namespace QAK {
     protected:
         void addToMenu(int index, QObject *object) override;
         void removeFromMenu(int index, QObject *object) override;
+        void moveInMenu(int from, int to, QObject *object) override;
     };
 
 }
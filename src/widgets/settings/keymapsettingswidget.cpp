@@ -1 +1,521 @@
 #include "keymapsettingswidget.h"
+#include "keymapsettingswidget_p.h"
+
+#include <algorithm>
+
+#include <QtCore/QSet>
+#include <QtGui/QBrush>
+#include <QtGui/QFont>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QTreeView>
+#include <QtWidgets/QVBoxLayout>
+
+#include <QAKCore/actionregistry.h>
+
+namespace QAK {
+
+    static QKeySequence keySequencePrefix(const QKeySequence &key, int count) {
+        int keys[4] = {};
+        for (int i = 0; i < count; ++i) {
+            keys[i] = key[i].toCombined();
+        }
+        return QKeySequence(keys[0], keys[1], keys[2], keys[3]);
+    }
+
+    void KeymapModel::reload() {
+        beginResetModel();
+        rows.clear();
+        rowsById.clear();
+        visible.clear();
+        editedKeys.clear();
+        editedPrefixes.clear();
+        edits.clear();
+        if (m_registry) {
+            const auto ids = m_registry->actionIds();
+            rows.reserve(ids.size());
+            for (const auto &id : ids) {
+                const auto info = m_registry->actionInfo(id);
+                if (info.type() != ActionItemInfo::Action)
+                    continue;
+                Row row;
+                row.id = info.id();
+                row.text = info.text(true);
+                if (row.text.isEmpty())
+                    row.text = row.id;
+                row.actionClass = info.actionClass(true);
+                row.defaults = info.shortcuts();
+                row.foldedText = row.text.toCaseFolded();
+                row.foldedClass = row.actionClass.toCaseFolded();
+                row.foldedId = row.id.toCaseFolded();
+                setKeys(row, m_registry->actionShortcuts(row.id));
+                rowsById.insert(row.id, int(rows.size()));
+                rows.append(row);
+            }
+        }
+        for (int i = 0; i < rows.size(); i++) {
+            if (matches(rows[i], filterScope, filterText))
+                visible.append(i);
+        }
+        endResetModel();
+    }
+
+    void KeymapModel::setFilter(const QString &text) {
+        Scope scope = AllScope;
+        QString needle = text.trimmed();
+        static const QPair<QLatin1String, Scope> prefixes[] = {
+            {QLatin1String("text:"),  TextScope },
+            {QLatin1String("class:"), ClassScope},
+            {QLatin1String("id:"),    IdScope   },
+            {QLatin1String("key:"),   KeyScope  },
+        };
+        for (const auto &prefix : prefixes) {
+            if (needle.startsWith(prefix.first, Qt::CaseInsensitive)) {
+                scope = prefix.second;
+                needle = needle.mid(prefix.first.size()).trimmed();
+                break;
+            }
+        }
+        needle = needle.toCaseFolded();
+        if (scope == filterScope && needle == filterText)
+            return;
+
+        // A refinement of the previous filter only needs to search the rows shown
+        const bool refinement = scope == filterScope && needle.contains(filterText);
+        filterScope = scope;
+        filterText = needle;
+
+        QVector<int> result;
+        if (refinement) {
+            for (int i : std::as_const(visible)) {
+                if (matches(rows[i], scope, needle))
+                    result.append(i);
+            }
+        } else {
+            for (int i = 0; i < rows.size(); i++) {
+                if (matches(rows[i], scope, needle))
+                    result.append(i);
+            }
+        }
+        setVisible(result);
+    }
+
+    void KeymapModel::setVisible(const QVector<int> &result) {
+        // Both lists are ascending, remove the rows filtered out, then insert the rows filtered
+        // in, a run of adjacent rows at a time
+        int j = 0;
+        for (int i = 0; i < visible.size();) {
+            if (j < result.size() && result.at(j) <= visible.at(i)) {
+                if (result.at(j) == visible.at(i))
+                    i++;
+                j++;
+                continue;
+            }
+            int end = i + 1;
+            while (end < visible.size() && (j >= result.size() || result.at(j) > visible.at(end)))
+                end++;
+            beginRemoveRows({}, i, end - 1);
+            visible.remove(i, end - i);
+            endRemoveRows();
+        }
+
+        // The rows left are all in the result
+        for (int i = 0, j = 0; j < result.size();) {
+            if (i < visible.size() && visible.at(i) == result.at(j)) {
+                i++;
+                j++;
+                continue;
+            }
+            int end = j + 1;
+            while (end < result.size() && (i >= visible.size() || result.at(end) < visible.at(i)))
+                end++;
+            beginInsertRows({}, i, i + end - j - 1);
+            visible = visible.mid(0, i) + result.mid(j, end - j) + visible.mid(i);
+            endInsertRows();
+            i += end - j;
+            j = end;
+        }
+    }
+
+    bool KeymapModel::matches(const Row &row, Scope scope, const QString &text) const {
+        if (text.isEmpty())
+            return true;
+        switch (scope) {
+            case TextScope:
+                return row.foldedText.contains(text);
+            case ClassScope:
+                return row.foldedClass.contains(text);
+            case IdScope:
+                return row.foldedId.contains(text);
+            case KeyScope:
+                return row.foldedKeys.contains(text);
+            default:
+                return row.foldedText.contains(text) || row.foldedClass.contains(text) ||
+                       row.foldedId.contains(text) || row.foldedKeys.contains(text);
+        }
+    }
+
+    void KeymapModel::setKeys(Row &row, const QList<QKeySequence> &keys) {
+        row.keys = keys;
+        row.keysText = QKeySequence::listToString(keys, QKeySequence::NativeText);
+        row.foldedKeys = QKeySequence::listToString(keys, QKeySequence::PortableText).toCaseFolded() +
+                         QLatin1Char('\n') + row.keysText.toCaseFolded();
+    }
+
+    void KeymapModel::indexEdit(const Row &row) {
+        for (const auto &key : row.keys) {
+            editedKeys[key].append(row.id);
+            for (int i = 1; i < key.count(); ++i) {
+                auto &ids = editedPrefixes[keySequencePrefix(key, i)];
+                if (!ids.contains(row.id))
+                    ids.append(row.id);
+            }
+        }
+    }
+
+    void KeymapModel::unindexEdit(const Row &row) {
+        const auto &remove = [&row](QHash<QKeySequence, QStringList> &index, const QKeySequence &key) {
+            if (auto it = index.find(key); it != index.end()) {
+                it->removeAll(row.id);
+                if (it->isEmpty())
+                    index.erase(it);
+            }
+        };
+        for (const auto &key : row.keys) {
+            remove(editedKeys, key);
+            for (int i = 1; i < key.count(); ++i) {
+                remove(editedPrefixes, keySequencePrefix(key, i));
+            }
+        }
+    }
+
+    QStringList KeymapModel::shortcutActions(const QKeySequence &key) const {
+        QStringList ids;
+        for (const auto &id : m_registry->shortcutActions(key)) {
+            if (!edits.contains(id))
+                ids.append(id);
+        }
+        return ids + editedKeys.value(key);
+    }
+
+    QStringList KeymapModel::shortcutPrefixActions(const QKeySequence &key) const {
+        QStringList ids;
+        for (const auto &id : m_registry->shortcutPrefixActions(key)) {
+            if (!edits.contains(id))
+                ids.append(id);
+        }
+        return ids + editedPrefixes.value(key);
+    }
+
+    // Like ActionRegistry::isShortcutConflicting() and isShortcutAmbiguous() with the edits
+    bool KeymapModel::isConflicting(const Row &row, const QKeySequence &key) const {
+        if (!m_registry)
+            return false;
+        const auto ids = shortcutActions(key);
+        if (std::any_of(ids.begin(), ids.end(), [&row](const QString &id) { return id != row.id; }))
+            return true;
+        // A chord prefix of another binding, or the other way round
+        if (!shortcutPrefixActions(key).isEmpty())
+            return true;
+        for (int i = 1; i < key.count(); ++i) {
+            if (!shortcutActions(keySequencePrefix(key, i)).isEmpty())
+                return true;
+        }
+        return false;
+    }
+
+    QList<QKeySequence> KeymapModel::conflictingKeys(const Row &row) const {
+        QList<QKeySequence> keys;
+        for (const auto &key : row.keys) {
+            if (isConflicting(row, key))
+                keys.append(key);
+        }
+        return keys;
+    }
+
+    void KeymapModel::emitRowChanged(const Row &row, const QList<QKeySequence> &oldKeys) {
+        const auto &modelRow = [this](const QString &id) {
+            const int i = rowsById.value(id, -1);
+            const auto it = std::lower_bound(visible.cbegin(), visible.cend(), i);
+            return it != visible.cend() && *it == i ? int(it - visible.cbegin()) : -1;
+        };
+        if (const int i = modelRow(row.id); i >= 0)
+            emit dataChanged(index(i, 0), index(i, ColumnCount - 1));
+        if (!m_registry)
+            return;
+
+        // The rows sharing a key or a chord prefix with the old or the new keys
+        QSet<QString> ids;
+        const auto &collect = [&](const QKeySequence &key) {
+            for (const auto &id : shortcutActions(key))
+                ids.insert(id);
+            for (const auto &id : shortcutPrefixActions(key))
+                ids.insert(id);
+            for (int i = 1; i < key.count(); ++i) {
+                for (const auto &id : shortcutActions(keySequencePrefix(key, i)))
+                    ids.insert(id);
+            }
+        };
+        for (const auto &key : oldKeys)
+            collect(key);
+        for (const auto &key : row.keys)
+            collect(key);
+        ids.remove(row.id);
+        for (const auto &id : std::as_const(ids)) {
+            if (const int i = modelRow(id); i >= 0) {
+                const auto keysIndex = index(i, ShortcutsColumn);
+                emit dataChanged(keysIndex, keysIndex, {Qt::ForegroundRole, Qt::ToolTipRole});
+            }
+        }
+    }
+
+    ActionFamily::ShortcutsFamily KeymapModel::mergedFamily() const {
+        auto family = m_registry ? m_registry->shortcutsFamily() : ActionFamily::ShortcutsFamily();
+        for (const auto &row : rows) {
+            auto it = edits.constFind(row.id);
+            if (it == edits.cend())
+                continue;
+            // Keys equal to the defaults do not need an override
+            family.remove(row.id);
+            if (it.value() && it.value().value() != row.defaults)
+                family.insert(row.id, it.value());
+        }
+        return family;
+    }
+
+    void KeymapModel::clearEdits() {
+        // The registry holds the edited keys by now
+        const bool wasModified = isModified();
+        edits.clear();
+        editedKeys.clear();
+        editedPrefixes.clear();
+        if (wasModified)
+            emit modifiedChanged();
+    }
+
+    void KeymapModel::resetRow(int row) {
+        if (row < 0 || row >= visible.size())
+            return;
+        auto &data = rows[visible[row]];
+        const bool wasModified = isModified();
+        const auto oldKeys = data.keys;
+        if (edits.contains(data.id))
+            unindexEdit(data);
+        setKeys(data, data.defaults);
+        // Dropping an override is the same as setting the defaults
+        if (m_registry && !m_registry->shortcuts(data.id)) {
+            edits.remove(data.id);
+        } else {
+            edits.insert(data.id, std::nullopt);
+            indexEdit(data);
+        }
+        emitRowChanged(data, oldKeys);
+        if (wasModified != isModified())
+            emit modifiedChanged();
+    }
+
+    QVariant KeymapModel::data(const QModelIndex &index, int role) const {
+        if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+            return {};
+        const auto &row = rows.at(visible.at(index.row()));
+        switch (role) {
+            case Qt::DisplayRole:
+                switch (index.column()) {
+                    case TextColumn:
+                        return row.text;
+                    case ClassColumn:
+                        return row.actionClass;
+                    case IdColumn:
+                        return row.id;
+                    case ShortcutsColumn:
+                        return row.keysText;
+                    default:
+                        return {};
+                }
+            case Qt::EditRole:
+                if (index.column() == ShortcutsColumn)
+                    return QKeySequence::listToString(row.keys, QKeySequence::NativeText);
+                return {};
+            case Qt::ForegroundRole:
+                if (index.column() == ShortcutsColumn && !conflictingKeys(row).isEmpty())
+                    return QBrush(Qt::red);
+                return {};
+            case Qt::ToolTipRole: {
+                if (index.column() != ShortcutsColumn)
+                    return {};
+                const auto keys = conflictingKeys(row);
+                if (keys.isEmpty())
+                    return {};
+                return KeymapSettingsWidget::tr("Conflicting shortcuts: %1")
+                    .arg(QKeySequence::listToString(keys, QKeySequence::NativeText));
+            }
+            case Qt::FontRole:
+                if (edits.contains(row.id)) {
+                    QFont font;
+                    font.setItalic(true);
+                    return font;
+                }
+                return {};
+            default:
+                return {};
+        }
+    }
+
+    QVariant KeymapModel::headerData(int section, Qt::Orientation orientation, int role) const {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+            return {};
+        switch (section) {
+            case TextColumn:
+                return KeymapSettingsWidget::tr("Action");
+            case ClassColumn:
+                return KeymapSettingsWidget::tr("Class");
+            case IdColumn:
+                return KeymapSettingsWidget::tr("Id");
+            case ShortcutsColumn:
+                return KeymapSettingsWidget::tr("Shortcuts");
+            default:
+                return {};
+        }
+    }
+
+    Qt::ItemFlags KeymapModel::flags(const QModelIndex &index) const {
+        auto flags = QAbstractTableModel::flags(index);
+        if (index.isValid() && index.column() == ShortcutsColumn)
+            flags |= Qt::ItemIsEditable;
+        return flags;
+    }
+
+    bool KeymapModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+        if (role != Qt::EditRole || index.column() != ShortcutsColumn ||
+            !checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+            return false;
+        auto &row = rows[visible[index.row()]];
+        QList<QKeySequence> keys;
+        for (const auto &key : QKeySequence::listFromString(value.toString(), QKeySequence::NativeText)) {
+            if (!key.isEmpty() && !keys.contains(key))
+                keys.append(key);
+        }
+        if (keys == row.keys)
+            return true;
+        const bool wasModified = isModified();
+        const auto oldKeys = row.keys;
+        if (edits.contains(row.id))
+            unindexEdit(row);
+        edits.insert(row.id, keys);
+        setKeys(row, keys);
+        indexEdit(row);
+        emitRowChanged(row, oldKeys);
+        if (wasModified != isModified())
+            emit modifiedChanged();
+        return true;
+    }
+
+    class KeymapSettingsWidgetPrivate {
+        Q_DECLARE_PUBLIC(KeymapSettingsWidget)
+    public:
+        KeymapSettingsWidget *q_ptr;
+
+        KeymapModel *model;
+        QLineEdit *filterEdit;
+        QTreeView *view;
+        QPushButton *resetButton;
+    };
+
+    KeymapSettingsWidget::KeymapSettingsWidget(QWidget *parent)
+        : QWidget(parent), d_ptr(new KeymapSettingsWidgetPrivate) {
+        Q_D(KeymapSettingsWidget);
+        d->q_ptr = this;
+
+        d->model = new KeymapModel(this);
+        connect(d->model, &KeymapModel::modifiedChanged, this, [this] {
+            emit modifiedChanged(isModified());
+        });
+
+        d->filterEdit = new QLineEdit();
+        d->filterEdit->setClearButtonEnabled(true);
+        d->filterEdit->setPlaceholderText(tr("Type to search, or use text:, class:, id: or key:"));
+        connect(d->filterEdit, &QLineEdit::textChanged, this, &KeymapSettingsWidget::setFilterText);
+
+        d->resetButton = new QPushButton(tr("Reset"));
+        connect(d->resetButton, &QPushButton::clicked, this, &KeymapSettingsWidget::resetSelected);
+
+        // Uniform rows let the view lay out only the visible rows of a very long list
+        d->view = new QTreeView();
+        d->view->setModel(d->model);
+        d->view->setRootIsDecorated(false);
+        d->view->setUniformRowHeights(true);
+        d->view->setAlternatingRowColors(true);
+        d->view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        d->view->setSelectionBehavior(QAbstractItemView::SelectRows);
+        d->view->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
+        d->view->header()->setSectionResizeMode(QHeaderView::Interactive);
+        d->view->header()->setStretchLastSection(true);
+
+        auto filterLayout = new QHBoxLayout();
+        filterLayout->setContentsMargins({});
+        filterLayout->addWidget(d->filterEdit);
+        filterLayout->addWidget(d->resetButton);
+
+        auto layout = new QVBoxLayout(this);
+        layout->addLayout(filterLayout);
+        layout->addWidget(d->view);
+    }
+
+    KeymapSettingsWidget::~KeymapSettingsWidget() = default;
+
+    ActionRegistry *KeymapSettingsWidget::registry() const {
+        Q_D(const KeymapSettingsWidget);
+        return d->model->registry();
+    }
+
+    void KeymapSettingsWidget::setRegistry(ActionRegistry *registry) {
+        Q_D(KeymapSettingsWidget);
+        const bool wasModified = isModified();
+        d->model->setRegistry(registry);
+        if (wasModified)
+            emit modifiedChanged(false);
+    }
+
+    bool KeymapSettingsWidget::isModified() const {
+        Q_D(const KeymapSettingsWidget);
+        return d->model->isModified();
+    }
+
+    void KeymapSettingsWidget::setFilterText(const QString &text) {
+        Q_D(KeymapSettingsWidget);
+        if (d->filterEdit->text() != text) {
+            d->filterEdit->setText(text); // comes back through textChanged
+            return;
+        }
+        d->model->setFilter(text);
+    }
+
+    void KeymapSettingsWidget::load() {
+        Q_D(KeymapSettingsWidget);
+        const bool wasModified = isModified();
+        d->model->reload();
+        if (wasModified)
+            emit modifiedChanged(false);
+    }
+
+    void KeymapSettingsWidget::apply() {
+        Q_D(KeymapSettingsWidget);
+        auto reg = registry();
+        if (!reg || !isModified())
+            return;
+        reg->setShortcutsFamily(d->model->mergedFamily());
+        reg->updateContext(AE_Keymap);
+        d->model->clearEdits();
+    }
+
+    void KeymapSettingsWidget::resetSelected() {
+        Q_D(KeymapSettingsWidget);
+        const auto rows = d->view->selectionModel()->selectedRows();
+        for (const auto &index : rows) {
+            d->model->resetRow(index.row());
+        }
+    }
+
+}
@@ -1,5 +1,52 @@
 #ifndef KEYMAPSETTINGSWIDGET_H
 #define KEYMAPSETTINGSWIDGET_H
 
+#include <QtWidgets/QWidget>
+
+#include <QAKWidgets/qakwidgetsglobal.h>
+
+namespace QAK {
+
+    class ActionRegistry;
+
+    class KeymapSettingsWidgetPrivate;
+
+    /// \class KeymapSettingsWidget
+    /// \brief KeymapSettingsWidget edits the shortcuts of all actions of a registry. The edits are
+    /// kept in the widget until \c apply() commits them to the registry at once.
+    class QAK_WIDGETS_EXPORT KeymapSettingsWidget : public QWidget {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(KeymapSettingsWidget)
+    public:
+        explicit KeymapSettingsWidget(QWidget *parent = nullptr);
+        ~KeymapSettingsWidget() override;
+
+        ActionRegistry *registry() const;
+        void setRegistry(ActionRegistry *registry);
+
+        /// Returns whether there are edits not applied yet.
+        bool isModified() const;
+
+        /// Sets the filter, the rows whose text, class, id or shortcuts contain \a text are shown.
+        /// The prefixes "text:", "class:", "id:" and "key:" restrict the search to one column. A
+        /// filter extending the previous one only searches the rows already shown.
+        void setFilterText(const QString &text);
+
+    public Q_SLOTS:
+        /// Discards the edits and reloads the keymap from the registry.
+        void load();
+        /// Commits the edits to the registry as one \c ActionFamily::ShortcutsFamily.
+        void apply();
+        /// Resets the shortcuts of the selected actions to their defaults.
+        void resetSelected();
+
+    Q_SIGNALS:
+        void modifiedChanged(bool modified);
+
+    private:
+        QScopedPointer<KeymapSettingsWidgetPrivate> d_ptr;
+    };
+
+}
 
 #endif // KEYMAPSETTINGSWIDGET_H
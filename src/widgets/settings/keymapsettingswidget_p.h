@@ -0,0 +1,120 @@
+#ifndef KEYMAPSETTINGSWIDGET_P_H
+#define KEYMAPSETTINGSWIDGET_P_H
+
+//
+//  W A R N I N G !!!
+//  -----------------
+//
+// This file is not part of the QActionKit API. It is used purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or may even be removed.
+//
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QPointer>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKWidgets/qakwidgetsglobal.h>
+
+namespace QAK {
+
+    // A flat table over the actions of the registry, the shortcuts are read from the registry
+    // unless edited in the model. The rows hidden by the filter are not part of the model.
+    class QAK_WIDGETS_EXPORT KeymapModel : public QAbstractTableModel {
+        Q_OBJECT
+    public:
+        enum Column {
+            TextColumn,
+            ClassColumn,
+            IdColumn,
+            ShortcutsColumn,
+            ColumnCount,
+        };
+
+        explicit KeymapModel(QObject *parent = nullptr) : QAbstractTableModel(parent) {
+        }
+
+        ActionRegistry *registry() const {
+            return m_registry;
+        }
+        void setRegistry(ActionRegistry *registry) {
+            m_registry = registry;
+            reload();
+        }
+
+        void reload();
+        void setFilter(const QString &text);
+
+        bool isModified() const {
+            return !edits.isEmpty();
+        }
+        ActionFamily::ShortcutsFamily mergedFamily() const;
+        void clearEdits();
+        void resetRow(int row);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+            return parent.isValid() ? 0 : int(visible.size());
+        }
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override {
+            return parent.isValid() ? 0 : ColumnCount;
+        }
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+        Qt::ItemFlags flags(const QModelIndex &index) const override;
+        bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+
+    Q_SIGNALS:
+        void modifiedChanged();
+
+    protected:
+        struct Row {
+            QString id;
+            QString text;
+            QString actionClass;
+            QList<QKeySequence> defaults;
+            QList<QKeySequence> keys;
+            QString keysText;
+            // case folded copies for the filter
+            QString foldedText;
+            QString foldedClass;
+            QString foldedId;
+            QString foldedKeys;
+        };
+        QVector<Row> rows;
+        QHash<QString, int> rowsById;
+        QVector<int> visible; // model row -> row, ascending
+
+        QPointer<ActionRegistry> m_registry;
+        ActionFamily::ShortcutsFamily edits; // nullopt resets to the defaults
+
+        // The reverse shortcut index of the edited rows, applied over the one of the registry
+        // which still holds the keys before the edits
+        QHash<QKeySequence, QStringList> editedKeys;
+        QHash<QKeySequence, QStringList> editedPrefixes; // chord prefix -> [id]
+        void indexEdit(const Row &row);
+        void unindexEdit(const Row &row);
+        QStringList shortcutActions(const QKeySequence &key) const;
+        QStringList shortcutPrefixActions(const QKeySequence &key) const;
+
+        enum Scope {
+            AllScope,
+            TextScope,
+            ClassScope,
+            IdScope,
+            KeyScope,
+        };
+        Scope filterScope = AllScope;
+        QString filterText; // folded
+
+        bool matches(const Row &row, Scope scope, const QString &text) const;
+        void setVisible(const QVector<int> &result);
+        void setKeys(Row &row, const QList<QKeySequence> &keys);
+        bool isConflicting(const Row &row, const QKeySequence &key) const;
+        QList<QKeySequence> conflictingKeys(const Row &row) const;
+        // Emits the change of the row and of the rows whose conflicts may have changed with it
+        void emitRowChanged(const Row &row, const QList<QKeySequence> &oldKeys);
+    };
+
+}
+
+#endif // KEYMAPSETTINGSWIDGET_P_H
@@ -1 +1,352 @@
 #include "layoutssettingswidget.h"
+
+#include <algorithm>
+
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
+#include <QtGui/QDropEvent>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QStyledItemDelegate>
+#include <QtWidgets/QTreeView>
+#include <QtWidgets/QVBoxLayout>
+
+#include <QAKCore/actionlayoutsmodel.h>
+#include <QAKCore/actionregistry.h>
+
+namespace QAK {
+
+    static inline ActionLayoutEntry entryOf(const QModelIndex &index) {
+        return index.data(Qt::UserRole).value<ActionLayoutEntry>();
+    }
+
+    static inline bool isContainer(const ActionLayoutEntry &entry) {
+        return entry.type() == ActionLayoutEntry::Menu || entry.type() == ActionLayoutEntry::Group;
+    }
+
+    // Moves the dropped rows with ActionLayoutsModel::moveRows() instead of encoding and
+    // decoding them, so that a drop costs as much as the rows moved
+    class LayoutsView : public QTreeView {
+    public:
+        explicit LayoutsView(QWidget *parent = nullptr) : QTreeView(parent) {
+        }
+
+    protected:
+        void dropEvent(QDropEvent *event) override;
+    };
+
+    void LayoutsView::dropEvent(QDropEvent *event) {
+        if (event->source() != this || !model()) {
+            event->ignore();
+            return;
+        }
+
+        const auto target = indexAt(event->position().toPoint());
+        QModelIndex parent;
+        int row;
+        switch (dropIndicatorPosition()) {
+            case OnItem:
+                if (!target.parent().isValid() || isContainer(entryOf(target))) {
+                    parent = target;
+                    row = model()->rowCount(target);
+                    break;
+                }
+                Q_FALLTHROUGH();
+            case BelowItem:
+                parent = target.parent();
+                row = target.row() + 1;
+                break;
+            case AboveItem:
+                parent = target.parent();
+                row = target.row();
+                break;
+            default:
+                event->ignore();
+                return;
+        }
+        if (!parent.isValid()) {
+            event->ignore();
+            return;
+        }
+
+        auto indexes = selectionModel()->selectedRows();
+        std::sort(indexes.begin(), indexes.end(), [this](const QModelIndex &a, const QModelIndex &b) {
+            return visualRect(a).top() < visualRect(b).top();
+        });
+        QList<QPersistentModelIndex> sources;
+        for (const auto &index : std::as_const(indexes)) {
+            if (index.parent().isValid())
+                sources.append(index);
+        }
+
+        // The destination is tracked by a persistent index since the moves shift its rows
+        const QPersistentModelIndex destination(parent);
+        for (const auto &source : std::as_const(sources)) {
+            if (!source.isValid() || !destination.isValid())
+                break;
+            const auto sourceParent = source.parent();
+            const int sourceRow = source.row();
+            if (sourceParent == destination && (sourceRow == row || sourceRow + 1 == row)) {
+                // Already in place
+                row = sourceRow + 1;
+                continue;
+            }
+            if (!model()->moveRows(sourceParent, sourceRow, 1, destination, row))
+                continue;
+            if (!(sourceParent == destination && sourceRow < row))
+                row++;
+        }
+
+        // The drop is complete, prevent the view from removing the source rows
+        event->setDropAction(Qt::IgnoreAction);
+        event->accept();
+    }
+
+    class LayoutsItemDelegate : public QStyledItemDelegate {
+    public:
+        explicit LayoutsItemDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {
+        }
+
+        QPointer<ActionRegistry> registry;
+
+    protected:
+        void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override {
+            QStyledItemDelegate::initStyleOption(option, index);
+            const auto entry = entryOf(index);
+            switch (entry.type()) {
+                case ActionLayoutEntry::Separator:
+                    option->text = LayoutsSettingsWidget::tr("Separator");
+                    option->font.setItalic(true);
+                    return;
+                case ActionLayoutEntry::Stretch:
+                    option->text = LayoutsSettingsWidget::tr("Stretch");
+                    option->font.setItalic(true);
+                    return;
+                default:
+                    break;
+            }
+            if (!registry)
+                return;
+            // Only the painted rows query their text
+            const auto text = registry->actionInfo(entry.id()).text(true);
+            if (!text.isEmpty())
+                option->text = text;
+        }
+    };
+
+    class LayoutsSettingsWidgetPrivate {
+        Q_DECLARE_PUBLIC(LayoutsSettingsWidget)
+    public:
+        LayoutsSettingsWidget *q_ptr;
+
+        QPointer<ActionRegistry> registry;
+        ActionLayoutsModel *model;
+        LayoutsView *view;
+        LayoutsItemDelegate *delegate;
+
+        QSet<QString> dirtyNodes; // the nodes whose children have been edited
+        bool loading = false;
+
+        void markDirty(const QModelIndex &parent);
+        void insertEntry(ActionLayoutEntry::Type type);
+    };
+
+    void LayoutsSettingsWidgetPrivate::markDirty(const QModelIndex &parent) {
+        Q_Q(LayoutsSettingsWidget);
+        if (loading || !parent.isValid())
+            return;
+        const auto id = entryOf(parent).id();
+        if (id.isEmpty())
+            return;
+        const bool wasModified = !dirtyNodes.isEmpty();
+        dirtyNodes.insert(id);
+        if (!wasModified)
+            emit q->modifiedChanged(true);
+    }
+
+    void LayoutsSettingsWidgetPrivate::insertEntry(ActionLayoutEntry::Type type) {
+        const auto current = view->currentIndex();
+        if (!current.isValid())
+            return;
+
+        QModelIndex parent;
+        int row;
+        if (!current.parent().isValid() || (isContainer(entryOf(current)) && view->isExpanded(current))) {
+            parent = current;
+            row = 0;
+        } else {
+            parent = current.parent();
+            row = current.row() + 1;
+        }
+
+        if (!model->insertRows(row, 1, parent))
+            return;
+        const auto index = model->index(row, 0, parent);
+        if (!model->setData(index, QVariant::fromValue(ActionLayoutEntry({}, type)), Qt::UserRole)) {
+            model->removeRows(row, 1, parent);
+            return;
+        }
+        view->setCurrentIndex(index);
+    }
+
+    LayoutsSettingsWidget::LayoutsSettingsWidget(QWidget *parent)
+        : QWidget(parent), d_ptr(new LayoutsSettingsWidgetPrivate) {
+        Q_D(LayoutsSettingsWidget);
+        d->q_ptr = this;
+
+        d->model = new ActionLayoutsModel(this);
+        connect(d->model, &QAbstractItemModel::rowsInserted, this,
+                [d](const QModelIndex &parent) { d->markDirty(parent); });
+        connect(d->model, &QAbstractItemModel::rowsRemoved, this,
+                [d](const QModelIndex &parent) { d->markDirty(parent); });
+        connect(d->model, &QAbstractItemModel::rowsMoved, this,
+                [d](const QModelIndex &parent, int, int, const QModelIndex &destination) {
+                    d->markDirty(parent);
+                    d->markDirty(destination);
+                });
+        connect(d->model, &QAbstractItemModel::dataChanged, this,
+                [d](const QModelIndex &topLeft) { d->markDirty(topLeft.parent()); });
+
+        d->delegate = new LayoutsItemDelegate(this);
+
+        d->view = new LayoutsView();
+        d->view->setModel(d->model);
+        d->view->setItemDelegate(d->delegate);
+        d->view->setHeaderHidden(true);
+        d->view->setUniformRowHeights(true);
+        d->view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        d->view->setDragDropMode(QAbstractItemView::InternalMove);
+        d->view->setDefaultDropAction(Qt::MoveAction);
+        d->view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+        auto separatorButton = new QPushButton(tr("Add Separator"));
+        connect(separatorButton, &QPushButton::clicked, this, &LayoutsSettingsWidget::insertSeparator);
+        auto stretchButton = new QPushButton(tr("Add Stretch"));
+        connect(stretchButton, &QPushButton::clicked, this, &LayoutsSettingsWidget::insertStretch);
+        auto removeButton = new QPushButton(tr("Remove"));
+        connect(removeButton, &QPushButton::clicked, this, &LayoutsSettingsWidget::removeSelected);
+
+        auto buttonLayout = new QHBoxLayout();
+        buttonLayout->setContentsMargins({});
+        buttonLayout->addWidget(separatorButton);
+        buttonLayout->addWidget(stretchButton);
+        buttonLayout->addWidget(removeButton);
+        buttonLayout->addStretch();
+
+        auto layout = new QVBoxLayout(this);
+        layout->addWidget(d->view);
+        layout->addLayout(buttonLayout);
+    }
+
+    LayoutsSettingsWidget::~LayoutsSettingsWidget() = default;
+
+    ActionRegistry *LayoutsSettingsWidget::registry() const {
+        Q_D(const LayoutsSettingsWidget);
+        return d->registry;
+    }
+
+    void LayoutsSettingsWidget::setRegistry(ActionRegistry *registry) {
+        Q_D(LayoutsSettingsWidget);
+        d->registry = registry;
+        d->delegate->registry = registry;
+        load();
+    }
+
+    ActionLayoutsModel *LayoutsSettingsWidget::model() const {
+        Q_D(const LayoutsSettingsWidget);
+        return d->model;
+    }
+
+    bool LayoutsSettingsWidget::isModified() const {
+        Q_D(const LayoutsSettingsWidget);
+        return !d->dirtyNodes.isEmpty();
+    }
+
+    void LayoutsSettingsWidget::load() {
+        Q_D(LayoutsSettingsWidget);
+        const bool wasModified = isModified();
+        d->loading = true;
+
+        ActionLayouts layouts;
+        QVector<ActionLayoutEntry> topLevelNodes;
+        if (d->registry) {
+            layouts = d->registry->layouts();
+
+            // The roots of the DAG are the nodes that are no child of another node
+            const auto adjacencyMap = layouts.adjacencyMap();
+            QSet<QString> children;
+            for (const auto &entries : adjacencyMap) {
+                for (const auto &entry : entries) {
+                    if (!entry.id().isEmpty())
+                        children.insert(entry.id());
+                }
+            }
+            for (auto it = adjacencyMap.begin(); it != adjacencyMap.end(); ++it) {
+                if (children.contains(it.key()))
+                    continue;
+                const auto type = d->registry->actionInfo(it.key()).type();
+                if (type == ActionItemInfo::Menu) {
+                    topLevelNodes.append(ActionLayoutEntry(it.key(), ActionLayoutEntry::Menu));
+                } else if (type == ActionItemInfo::Group) {
+                    topLevelNodes.append(ActionLayoutEntry(it.key(), ActionLayoutEntry::Group));
+                } else if (!it.value().isEmpty()) {
+                    topLevelNodes.append(ActionLayoutEntry(it.key(), ActionLayoutEntry::Menu));
+                }
+            }
+        }
+        d->model->setActionLayouts(layouts);
+        d->model->setTopLevelNodes(topLevelNodes);
+
+        d->loading = false;
+        d->dirtyNodes.clear();
+        if (wasModified)
+            emit modifiedChanged(false);
+    }
+
+    void LayoutsSettingsWidget::apply() {
+        Q_D(LayoutsSettingsWidget);
+        if (!d->registry || d->dirtyNodes.isEmpty())
+            return;
+
+        const auto current = d->registry->layouts().adjacencyMap();
+        const auto edited = d->model->actionLayouts().adjacencyMap();
+        QMap<QString, QVector<ActionLayoutEntry>> nodes;
+        for (const auto &id : std::as_const(d->dirtyNodes)) {
+            const auto children = edited.value(id);
+            if (children != current.value(id))
+                nodes.insert(id, children);
+        }
+        d->dirtyNodes.clear();
+
+        if (!nodes.isEmpty()) {
+            d->registry->patchLayouts(nodes);
+            d->registry->updateContext(AE_Layouts);
+        }
+        emit modifiedChanged(false);
+    }
+
+    void LayoutsSettingsWidget::insertSeparator() {
+        Q_D(LayoutsSettingsWidget);
+        d->insertEntry(ActionLayoutEntry::Separator);
+    }
+
+    void LayoutsSettingsWidget::insertStretch() {
+        Q_D(LayoutsSettingsWidget);
+        d->insertEntry(ActionLayoutEntry::Stretch);
+    }
+
+    void LayoutsSettingsWidget::removeSelected() {
+        Q_D(LayoutsSettingsWidget);
+        const auto indexes = d->view->selectionModel()->selectedRows();
+        QList<QPersistentModelIndex> rows;
+        for (const auto &index : indexes) {
+            if (index.parent().isValid())
+                rows.append(index);
+        }
+        for (const auto &index : std::as_const(rows)) {
+            if (index.isValid())
+                d->model->removeRows(index.row(), 1, index.parent());
+        }
+    }
+
+}
@@ -1,5 +1,53 @@
 #ifndef LAYOUTSSETTINGSWIDGET_H
 #define LAYOUTSSETTINGSWIDGET_H
 
+#include <QtWidgets/QWidget>
+
+#include <QAKWidgets/qakwidgetsglobal.h>
+
+namespace QAK {
+
+    class ActionRegistry;
+    class ActionLayoutsModel;
+
+    class LayoutsSettingsWidgetPrivate;
+
+    /// \class LayoutsSettingsWidget
+    /// \brief LayoutsSettingsWidget edits the layouts of a registry in an \c ActionLayoutsModel.
+    /// The entries are reordered and moved across menus by drag and drop, and separators and
+    /// stretches can be inserted. \c apply() only commits the nodes that have changed.
+    class QAK_WIDGETS_EXPORT LayoutsSettingsWidget : public QWidget {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(LayoutsSettingsWidget)
+    public:
+        explicit LayoutsSettingsWidget(QWidget *parent = nullptr);
+        ~LayoutsSettingsWidget() override;
+
+        ActionRegistry *registry() const;
+        void setRegistry(ActionRegistry *registry);
+
+        ActionLayoutsModel *model() const;
+
+        /// Returns whether there are edits not applied yet.
+        bool isModified() const;
+
+    public Q_SLOTS:
+        /// Discards the edits and reloads the layouts from the registry.
+        void load();
+        /// Commits the changed nodes to the registry with \c ActionRegistry::patchLayouts().
+        void apply();
+
+        void insertSeparator();
+        void insertStretch();
+        void removeSelected();
+
+    Q_SIGNALS:
+        void modifiedChanged(bool modified);
+
+    private:
+        QScopedPointer<LayoutsSettingsWidgetPrivate> d_ptr;
+    };
+
+}
 
 #endif // LAYOUTSSETTINGSWIDGET_H
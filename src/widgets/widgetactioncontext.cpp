@@ -1,118 +1,691 @@
 #include "widgetactioncontext.h"
+#include "widgetactioncontext_p.h"
 
-#include <QtWidgets/QWidgetAction>
+#include <algorithm>
+
+#include <QtCore/QDebug>
+#include <QtWidgets/QApplication>
 
 #include <QAKCore/actionregistry.h>
-#include <QAKCore/private/actioncontext_p.h>
 
 namespace QAK {
 
-    class WidgetAction : public QWidgetAction {
-    public:
-        explicit WidgetAction(std::function<QWidget *(QWidget *)> fac, QObject *parent = nullptr)
-            : QWidgetAction(parent), fac(std::move(fac)) {
+    WidgetActionPlaceholder::WidgetActionPlaceholder(WidgetAction *action, QWidget *parent)
+        : QWidget(parent), action(action) {
+        auto layout = new QHBoxLayout(this);
+        layout->setContentsMargins({});
+        layout->setSpacing(0);
+        lastSizeHint = action->initialSizeHint(this);
+    }
+
+    WidgetActionPlaceholder::~WidgetActionPlaceholder() = default;
+
+    void WidgetActionPlaceholder::realize() {
+        if (w)
+            return;
+        w = action->fac(this);
+        if (!w)
+            return;
+        layout()->addWidget(w);
+        updateGeometry();
+    }
+
+    void WidgetActionPlaceholder::release() {
+        if (!w)
+            return;
+        lastSizeHint = w->sizeHint();
+        delete w.data();
+    }
+
+    QSize WidgetActionPlaceholder::sizeHint() const {
+        return w ? QWidget::sizeHint() : lastSizeHint;
+    }
+
+    void WidgetActionPlaceholder::showEvent(QShowEvent *event) {
+        if (releaseTimer)
+            releaseTimer->stop();
+        realize();
+        QWidget::showEvent(event);
+    }
+
+    void WidgetActionPlaceholder::hideEvent(QHideEvent *event) {
+        QWidget::hideEvent(event);
+        if (!w || action->releaseTimeout < 0)
+            return;
+        if (!releaseTimer) {
+            releaseTimer = new QTimer(this);
+            releaseTimer->setSingleShot(true);
+            connect(releaseTimer, &QTimer::timeout, this, [this] {
+                if (!isVisible())
+                    release();
+            });
         }
+        releaseTimer->start(action->releaseTimeout);
+    }
 
-        inline QList<QWidget *> createdWidgets() const {
-            return QWidgetAction::createdWidgets();
+    QSize WidgetAction::initialSizeHint(QWidget *parent) {
+        if (!measuredSizeHint) {
+            QScopedPointer<QWidget> w(fac(parent));
+            measuredSizeHint = w ? w->sizeHint() : QSize();
         }
+        return *measuredSizeHint;
+    }
 
-    protected:
-        QWidget *createWidget(QWidget *parent) override {
-            auto w = fac(parent);
-            return w;
+    QList<QWidget *> WidgetAction::realizedWidgets() const {
+        QList<QWidget *> widgets;
+        for (auto widget : QWidgetAction::createdWidgets()) {
+            if (auto realized = static_cast<WidgetActionPlaceholder *>(widget)->widget())
+                widgets.append(realized);
         }
+        return widgets;
+    }
 
-        std::function<QWidget *(QWidget *)> fac;
+    WidgetSharedActionPool::WidgetSharedActionPool(ActionRegistry *registry) : QObject(registry) {
+        // Watches the input to route the shared actions to the context of the triggering widget
+        qApp->installEventFilter(this);
+    }
 
-        friend class ActionItem;
-    };
+    WidgetSharedActionPool::~WidgetSharedActionPool() {
+        // The registry is going away before its contexts
+        for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+            for (auto context : it->users) {
+                context->d_func()->dropSharedAction(it.key().id, it->action);
+            }
+            delete it->action;
+        }
+    }
 
-    struct ActionItem {
-        enum Type {
-            Action,
-            Menu,
-            MenuBar,
-            ToolBar,
-            Widget,
-        };
-        Type t;
-        QObject *o;
-        bool owned;
+    WidgetSharedActionPool *WidgetSharedActionPool::of(ActionRegistry *registry) {
+        auto pool = registry->findChild<WidgetSharedActionPool *>(QString(), Qt::FindDirectChildrenOnly);
+        if (!pool)
+            pool = new WidgetSharedActionPool(registry);
+        return pool;
+    }
 
-        QAction *action() const {
-            if (t == Action)
-                return static_cast<QAction *>(o);
-            return nullptr;
+    QAction *WidgetSharedActionPool::acquire(const QString &id, WidgetActionContext *context) {
+        const Key key{id, context->metaObject()};
+        auto &entry = entries[key];
+        if (!entry.action) {
+            auto action = context->createAction(id, this);
+            context->d_func()->applyProperties(id, action, WidgetActionContextPrivate::All);
+            QObject::connect(action, &QAction::triggered, this, [this, id, action] {
+                if (auto reg = qobject_cast<ActionRegistry *>(parent()))
+                    reg->recordUsage(id);
+                if (auto context = route(action))
+                    emit context->actionTriggered(id);
+            });
+            QObject::connect(action, &QAction::hovered, this, [this, id, action] {
+                if (auto context = route(action))
+                    emit context->actionHovered(id);
+            });
+            QObject::connect(action, &QAction::toggled, this, [this, id, action](bool checked) {
+                if (auto context = route(action))
+                    emit context->actionToggled(id, checked);
+            });
+            entry.action = action;
+            keys.insert(action, key);
         }
+        if (!entry.users.contains(context))
+            entry.users.append(context);
+        return entry.action;
+    }
 
-        QMenu *menu() const {
-            if (t == Menu)
-                return static_cast<QMenu *>(o);
-            return nullptr;
+    void WidgetSharedActionPool::release(QAction *action, WidgetActionContext *context) {
+        auto it = entries.find(keys.value(action));
+        if (it == entries.end() || it->action != action)
+            return;
+        it->users.removeOne(context);
+        if (it->users.isEmpty()) {
+            keys.remove(action);
+            action->deleteLater();
+            entries.erase(it);
         }
+    }
 
-        QMenuBar *menuBar() const {
-            if (t == MenuBar)
-                return static_cast<QMenuBar *>(o);
-            return nullptr;
+    bool WidgetSharedActionPool::eventFilter(QObject *watched, QEvent *event) {
+        switch (event->type()) {
+            case QEvent::MouseButtonPress:
+            case QEvent::MouseButtonRelease:
+            case QEvent::KeyPress:
+            case QEvent::ShortcutOverride:
+                if (watched->isWidgetType())
+                    inputWidget = static_cast<QWidget *>(watched);
+                break;
+            default:
+                break;
         }
+        return QObject::eventFilter(watched, event);
+    }
 
-        QToolBar *toolBar() const {
-            if (t == ToolBar)
-                return static_cast<QToolBar *>(o);
+    WidgetActionContext *WidgetSharedActionPool::route(QAction *action) const {
+        const auto &users = entries.value(keys.value(action)).users;
+        if (users.isEmpty())
             return nullptr;
+        if (inputWidget) {
+            // A menu or a floating tool bar is not a part of its main window
+            for (auto context : users) {
+                if (context->d_func()->ownsWidget(inputWidget))
+                    return context;
+            }
+            for (auto context : users) {
+                if (context->d_func()->ownsWindow(inputWidget->window()))
+                    return context;
+            }
         }
-
-        WidgetAction *widgetAction() const {
-            if (t == Widget)
-                return static_cast<WidgetAction *>(o);
-            return nullptr;
+        if (auto window = QApplication::activeWindow()) {
+            for (auto context : users) {
+                if (context->d_func()->ownsWindow(window))
+                    return context;
+            }
         }
+        return users.first();
+    }
 
-        ActionItem() : t(Type(0)), o(nullptr), owned(false) {
+    WidgetActionContextPrivate::~WidgetActionContextPrivate() {
+        Q_Q(WidgetActionContext);
+        for (const auto &item : std::as_const(items)) {
+            if (item.owned && item.o)
+                delete item.o.data();
         }
-        ActionItem(QAction *a) : t(Action), o(a), owned(false) {
+        qDeleteAll(createdMenus);
+        for (auto it = createdActions.cbegin(); it != createdActions.cend(); ++it) {
+            if (sharedActions.contains(it.value())) {
+                if (sharedPool)
+                    sharedPool->release(it.value(), q);
+            } else {
+                delete it.value();
+            }
         }
-        ActionItem(QMenu *m, bool own = true) : t(Menu), o(m), owned(own) {
+    }
+
+    void WidgetActionContextPrivate::releaseAction(QAction *action) {
+        Q_Q(WidgetActionContext);
+        if (sharedActions.remove(action)) {
+            if (sharedPool)
+                sharedPool->release(action, q);
+            return;
         }
-        ActionItem(QMenuBar *mb) : t(MenuBar), o(mb), owned(false) {
+        action->deleteLater();
+    }
+
+    void WidgetActionContextPrivate::dropSharedAction(const QString &id, QAction *action) {
+        sharedActions.remove(action);
+        forgetAction(action);
+        unindexObject(id, action);
+        if (createdActions.value(id) == action)
+            createdActions.remove(id);
+    }
+
+    void WidgetActionContextPrivate::registryChanged() {
+        Q_Q(WidgetActionContext);
+        if (!sharedPool || sharedPool->parent() == registry)
+            return;
+
+        // The actions of the previous registry are taken out, the next layout update builds the
+        // ones of the new registry
+        for (auto it = createdActions.begin(); it != createdActions.end();) {
+            auto action = it.value();
+            if (!sharedActions.remove(action)) {
+                ++it;
+                continue;
+            }
+            for (auto managed = managedActions.begin(); managed != managedActions.end(); ++managed) {
+                if (managed->removeOne(action))
+                    managed.key()->removeAction(action);
+            }
+            unindexObject(it.key(), action);
+            sharedPool->release(action, q);
+            it = createdActions.erase(it);
         }
-        ActionItem(QToolBar *tb) : t(ToolBar), o(tb), owned(false) {
+        sharedPool = nullptr;
+    }
+
+    bool WidgetActionContextPrivate::ownsWidget(const QWidget *widget) const {
+        for (auto w = widget; w; w = w->parentWidget()) {
+            if (managedActions.contains(const_cast<QWidget *>(w)))
+                return true;
+            for (const auto &item : items) {
+                if (item.container() == w)
+                    return true;
+            }
         }
-        ActionItem(std::function<QWidget *(QWidget *)> fac, const QString &id)
-            : t(Widget), o(new WidgetAction(std::move(fac))), owned(true) {
+        return false;
+    }
+
+    bool WidgetActionContextPrivate::ownsWindow(const QWidget *window) const {
+        for (const auto &item : items) {
+            if (auto container = item.container(); container && container->window() == window)
+                return true;
         }
+        return false;
+    }
 
-        ~ActionItem() {
-            if (owned) {
-                o->deleteLater();
+    void WidgetActionContextPrivate::indexObject(const QString &id, QObject *object) {
+        if (!objectsById.contains(id, object))
+            objectsById.insert(id, object);
+    }
+
+    void WidgetActionContextPrivate::unindexObject(const QString &id, QObject *object) {
+        objectsById.remove(id, object);
+    }
+
+    void WidgetActionContextPrivate::updateObjects(int properties, const QStringList &ids) {
+        if (!registry)
+            return;
+        const auto &update = [&](const QString &id, QObject *object) {
+            if (auto menu = qobject_cast<QMenu *>(object)) {
+                applyProperties(id, menu, properties);
+                return;
+            }
+            auto action = static_cast<QAction *>(object);
+            applyProperties(id, action, properties);
+            if ((properties & Text) && (attrs & WidgetActionContext::UpdateToolTipWithDescription)) {
+                if (auto widgetAction = dynamic_cast<WidgetAction *>(action)) {
+                    // The placeholders, the tool tip events of the factory widgets reach them
+                    for (auto widget : widgetAction->createdWidgets())
+                        widget->setToolTip(action->toolTip());
+                }
+            }
+        };
+        if (ids.isEmpty()) {
+            for (auto it = objectsById.cbegin(); it != objectsById.cend(); ++it) {
+                update(it.key(), it.value());
+            }
+            return;
+        }
+        for (const auto &id : ids) {
+            for (auto it = objectsById.constFind(id); it != objectsById.cend() && it.key() == id; ++it) {
+                update(id, it.value());
             }
         }
-    };
+    }
 
-    class WidgetActionContextPrivate : public ActionContextPrivate {
-        Q_DECLARE_PUBLIC(WidgetActionContext)
-    public:
-        WidgetActionContextPrivate() = default;
-        ~WidgetActionContextPrivate() = default;
+    void WidgetActionContextPrivate::setItem(const QString &id, const ActionItem &item) {
+        removeItem(id);
+        items.insert(id, item);
+        if (auto action = item.action())
+            connectAction(id, action);
+    }
 
-        WidgetActionContext::Attributes attrs;
-        QMap<QString, ActionItem> items;
+    void WidgetActionContextPrivate::removeItem(const QString &id) {
+        Q_Q(WidgetActionContext);
+        auto it = items.find(id);
+        if (it == items.end())
+            return;
+        const auto item = it.value();
+        items.erase(it);
+        if (item.o)
+            unindexObject(id, item.o);
+        if (auto action = item.action()) {
+            // Reconnect the other ids the same action is still registered with
+            QObject::disconnect(action, nullptr, q, nullptr);
+            for (auto it1 = items.cbegin(); it1 != items.cend(); ++it1) {
+                if (it1->action() == action)
+                    connectAction(it1.key(), action);
+            }
+        }
+        if (auto container = item.container()) {
+            // Give the container back to the application without the built actions
+            QObject::disconnect(container, nullptr, q, nullptr);
+            if (auto menu = item.menu()) {
+                lazyMenus.remove(menu);
+                dirtyMenus.remove(menu);
+            }
+            for (auto action : managedActions.take(container)) {
+                container->removeAction(action);
+                if (builtSeparators.remove(action))
+                    delete action;
+            }
+        }
+        if (item.owned && item.o)
+            item.o->deleteLater();
+    }
+
+    void WidgetActionContextPrivate::applyProperties(const QString &id, QAction *action, int properties) const {
+        const auto info = registry->actionInfo(id);
+        if (properties & Text) {
+            auto text = info.text(true);
+            if (text.isEmpty())
+                text = id;
+            action->setText(text);
+            if (attrs & WidgetActionContext::UpdateToolTipWithDescription) {
+                const auto description = info.description(true);
+                action->setToolTip(description.isEmpty() ? text : description);
+            } else {
+                action->setToolTip({}); // falls back to the text
+            }
+        }
+        if (properties & Icon) {
+            action->setIcon(registry->actionIcon(iconTheme, info.icon()).icon());
+        }
+        if (properties & Keymap) {
+            action->setShortcuts(registry->actionShortcuts(id));
+        }
+    }
 
-        void updateLayouts();
-    };
+    void WidgetActionContextPrivate::applyProperties(const QString &id, QMenu *menu, int properties) const {
+        const auto info = registry->actionInfo(id);
+        if (properties & Text) {
+            auto text = info.text(true);
+            if (text.isEmpty())
+                text = id;
+            menu->setTitle(text);
+            if (attrs & WidgetActionContext::UpdateToolTipWithDescription) {
+                const auto description = info.description(true);
+                menu->menuAction()->setToolTip(description.isEmpty() ? text : description);
+            } else {
+                menu->menuAction()->setToolTip({});
+            }
+        }
+        if (properties & Icon) {
+            menu->setIcon(registry->actionIcon(iconTheme, info.icon()).icon());
+        }
+    }
 
-    void WidgetActionContextPrivate::updateLayouts() {
+    void WidgetActionContextPrivate::connectAction(const QString &id, QAction *action) {
         Q_Q(WidgetActionContext);
+        QObject::connect(action, &QAction::triggered, q, [q, id] {
+            if (auto reg = q->registry())
+                reg->recordUsage(id);
+            emit q->actionTriggered(id);
+        });
+        QObject::connect(action, &QAction::hovered, q, [q, id] {
+            emit q->actionHovered(id);
+        });
+        QObject::connect(action, &QAction::toggled, q, [q, id](bool checked) {
+            emit q->actionToggled(id, checked);
+        });
+    }
 
+    void WidgetActionContextPrivate::updateLayouts() {
         auto reg = registry;
         if (!reg) {
             return;
         }
 
-        const auto &layouts = reg->layouts();
-        
+        BuildState state;
+        state.layouts = reg->layouts();
+        for (auto it = items.cbegin(); it != items.cend(); ++it) {
+            if (auto container = it->container(); container && !state.builtContainers.contains(container)) {
+                state.path.append(it.key());
+                buildContainer(it.key(), container, state);
+                state.path.removeLast();
+            }
+        }
+
+        // Drop the actions and submenus which are no longer shown anywhere, the contents of the
+        // lazy submenus waiting for population are kept until they are populated again
+        QSet<QAction *> pendingActions;
+        for (auto menu : std::as_const(dirtyMenus)) {
+            for (auto action : managedActions.value(menu))
+                pendingActions.insert(action);
+        }
+        for (auto it = createdActions.begin(); it != createdActions.end();) {
+            if (state.usedActions.contains(it.key()) || pendingActions.contains(it.value())) {
+                ++it;
+                continue;
+            }
+            forgetAction(it.value());
+            unindexObject(it.key(), it.value());
+            releaseAction(it.value());
+            it = createdActions.erase(it);
+        }
+        for (auto it = createdMenus.begin(); it != createdMenus.end();) {
+            if (state.usedMenus.contains(it.key()) || pendingActions.contains(it.value()->menuAction())) {
+                ++it;
+                continue;
+            }
+            forgetAction(it.value()->menuAction());
+            managedActions.remove(it.value());
+            dirtyMenus.remove(it.value());
+            unindexObject(it.key(), it.value());
+            it.value()->deleteLater();
+            it = createdMenus.erase(it);
+        }
+
+        scheduleWarmUp();
+    }
+
+    void WidgetActionContextPrivate::forgetAction(QAction *action) {
+        for (auto &actions : managedActions) {
+            actions.removeOne(action);
+        }
+    }
+
+    void WidgetActionContextPrivate::markDirty(const QString &id, QMenu *menu) {
+        Q_Q(WidgetActionContext);
+        dirtyMenus.insert(menu);
+        if (lazyMenus.contains(menu))
+            return;
+        lazyMenus.insert(menu, id);
+        QObject::connect(menu, &QMenu::aboutToShow, q, [this, menu] {
+            openCounts[lazyMenus.value(menu)]++;
+            populateMenu(menu);
+        });
+        QObject::connect(menu, &QObject::destroyed, q, [this, menu] {
+            lazyMenus.remove(menu);
+            dirtyMenus.remove(menu);
+        });
+    }
+
+    void WidgetActionContextPrivate::populateMenu(QMenu *menu) {
+        if (!registry || !dirtyMenus.remove(menu))
+            return;
+        const auto id = lazyMenus.value(menu);
+        BuildState state;
+        state.layouts = registry->layouts();
+        state.path.append(id);
+        buildContainer(id, menu, state);
+    }
+
+    void WidgetActionContextPrivate::scheduleWarmUp() {
+        Q_Q(WidgetActionContext);
+        warmUpQueue.clear();
+        if (!(attrs & WidgetActionContext::LazySubmenus) || warmUpCount <= 0)
+            return;
+
+        QList<QMenu *> candidates;
+        for (auto menu : std::as_const(dirtyMenus)) {
+            if (openCounts.value(lazyMenus.value(menu)) > 0)
+                candidates.append(menu);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](QMenu *a, QMenu *b) {
+            return openCounts.value(lazyMenus.value(a)) > openCounts.value(lazyMenus.value(b));
+        });
+        for (int i = 0; i < qMin(warmUpCount, int(candidates.size())); i++) {
+            warmUpQueue.append(candidates.at(i));
+        }
+        if (warmUpQueue.isEmpty())
+            return;
+
+        // Populate one menu per pass of the event loop
+        if (!warmUpTimer) {
+            warmUpTimer = new QTimer(q);
+            warmUpTimer->setInterval(0);
+            QObject::connect(warmUpTimer, &QTimer::timeout, q, [this] {
+                while (!warmUpQueue.isEmpty()) {
+                    if (auto menu = warmUpQueue.takeFirst()) {
+                        populateMenu(menu);
+                        break;
+                    }
+                }
+                if (warmUpQueue.isEmpty())
+                    warmUpTimer->stop();
+            });
+        }
+        warmUpTimer->start();
+    }
+
+    void WidgetActionContextPrivate::buildContainer(const QString &id, QWidget *container, BuildState &state) {
+        state.builtContainers.insert(container);
+
+        const auto entries = state.layouts.flattenedChildren(id);
+
+        // The separators and spacers of the previous build are reused in order
+        QList<QAction *> oldSeparators;
+        QList<QAction *> oldSpacers;
+        for (auto action : managedActions.value(container)) {
+            if (!builtSeparators.contains(action))
+                continue;
+            (action->isSeparator() ? oldSeparators : oldSpacers).append(action);
+        }
+
+        QList<QAction *> desired;
+        QSet<QAction *> added; // a widget holds an action at most once
+        const auto &append = [&](QAction *action) {
+            if (action && !added.contains(action)) {
+                added.insert(action);
+                desired.append(action);
+            }
+        };
+        for (const auto &entry : std::as_const(entries)) {
+            switch (entry.type()) {
+                case ActionLayoutEntry::Action:
+                    append(actionFor(entry.id(), state));
+                    break;
+                case ActionLayoutEntry::Menu:
+                    if (auto menu = menuFor(entry.id(), state))
+                        append(menu->menuAction());
+                    break;
+                case ActionLayoutEntry::Separator: {
+                    QAction *separator;
+                    if (!oldSeparators.isEmpty()) {
+                        separator = oldSeparators.takeFirst();
+                    } else {
+                        separator = new QAction(container);
+                        separator->setSeparator(true);
+                        builtSeparators.insert(separator);
+                    }
+                    append(separator);
+                    break;
+                }
+                case ActionLayoutEntry::Stretch: {
+                    // Only a tool bar can stretch, elsewhere the entry is ignored
+                    if (!qobject_cast<QToolBar *>(container))
+                        break;
+                    QAction *spacer;
+                    if (!oldSpacers.isEmpty()) {
+                        spacer = oldSpacers.takeFirst();
+                    } else {
+                        auto spacerWidget = new QWidget();
+                        spacerWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+                        auto spacerAction = new QWidgetAction(container);
+                        spacerAction->setDefaultWidget(spacerWidget);
+                        spacer = spacerAction;
+                        builtSeparators.insert(spacer);
+                    }
+                    append(spacer);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        patchActions(container, desired);
+    }
+
+    QAction *WidgetActionContextPrivate::actionFor(const QString &id, BuildState &state) {
+        Q_Q(WidgetActionContext);
+        if (auto it = items.constFind(id); it != items.constEnd()) {
+            if (auto action = it->action())
+                return action;
+            if (auto widgetAction = it->widgetAction()) {
+                if (!objectsById.contains(id, widgetAction)) {
+                    applyProperties(id, widgetAction, All);
+                    indexObject(id, widgetAction);
+                }
+                return widgetAction;
+            }
+        }
+        state.usedActions.insert(id);
+        auto &action = createdActions[id];
+        if (!action) {
+            if (attrs & WidgetActionContext::SharedActions) {
+                if (!sharedPool)
+                    sharedPool = WidgetSharedActionPool::of(registry);
+                action = sharedPool->acquire(id, q);
+                sharedActions.insert(action);
+            } else {
+                action = q->createAction(id, q);
+                applyProperties(id, action, All);
+                connectAction(id, action);
+            }
+            indexObject(id, action);
+        }
+        return action;
+    }
+
+    QMenu *WidgetActionContextPrivate::menuFor(const QString &id, BuildState &state) {
+        Q_Q(WidgetActionContext);
+        if (state.path.contains(id)) {
+            qWarning().noquote() << "QAK::WidgetActionContext: Recursive menu" << id;
+            return nullptr;
+        }
+        QMenu *menu = nullptr;
+        if (auto it = items.constFind(id); it != items.constEnd())
+            menu = it->menu();
+        if (!menu) {
+            state.usedMenus.insert(id);
+            auto &createdMenu = createdMenus[id];
+            if (!createdMenu) {
+                createdMenu = q->createSubMenu(id, nullptr);
+                applyProperties(id, createdMenu, All);
+                indexObject(id, createdMenu);
+            }
+            menu = createdMenu;
+        }
+        // A submenu shown in several containers is built once
+        if (!state.builtContainers.contains(menu)) {
+            if (attrs & WidgetActionContext::LazySubmenus) {
+                state.builtContainers.insert(menu);
+                markDirty(id, menu);
+            } else {
+                dirtyMenus.remove(menu);
+                state.path.append(id);
+                buildContainer(id, menu, state);
+                state.path.removeLast();
+            }
+        }
+        return menu;
+    }
+
+    void WidgetActionContextPrivate::patchActions(QWidget *container, const QList<QAction *> &desired) {
+        trackContainer(container);
+        auto &managed = managedActions[container];
+
+        const QSet<QAction *> desiredSet(desired.begin(), desired.end());
+        QList<QAction *> current;
+        current.reserve(managed.size());
+        for (auto action : std::as_const(managed)) {
+            if (desiredSet.contains(action)) {
+                current.append(action);
+                continue;
+            }
+            container->removeAction(action);
+            if (builtSeparators.remove(action))
+                delete action;
+        }
+
+        // Move or insert only the actions out of place, the others are left untouched
+        for (int i = 0; i < desired.size(); i++) {
+            const auto action = desired.at(i);
+            if (i < current.size() && current.at(i) == action)
+                continue;
+            const auto before = i < current.size() ? current.at(i) : nullptr;
+            current.removeOne(action);
+            container->insertAction(before, action);
+            current.insert(i, action);
+        }
+        managed = desired;
+    }
+
+    void WidgetActionContextPrivate::trackContainer(QWidget *container) {
+        Q_Q(WidgetActionContext);
+        if (managedActions.contains(container))
+            return;
+        QObject::connect(container, &QObject::destroyed, q, [this, container] {
+            managedActions.remove(container);
+        });
     }
 
     WidgetActionContext::WidgetActionContext(QObject *parent)
@@ -128,16 +701,52 @@ namespace QAK {
 
     void WidgetActionContext::setAttribute(Attribute attr, bool on) {
         Q_D(WidgetActionContext);
-        if (on) {
-            d->attrs |= attr;
-        } else {
-            d->attrs &= ~attr;
-        }
+        setAttributes(on ? (d->attrs | attr) : (d->attrs & ~attr));
     }
 
     void WidgetActionContext::setAttributes(Attributes attrs) {
         Q_D(WidgetActionContext);
+        const auto changed = d->attrs ^ attrs;
         d->attrs = attrs;
+        if (changed & UpdateToolTipWithDescription) {
+            d->updateObjects(WidgetActionContextPrivate::Text, {});
+        }
+    }
+
+    int WidgetActionContext::warmUpCount() const {
+        Q_D(const WidgetActionContext);
+        return d->warmUpCount;
+    }
+
+    void WidgetActionContext::setWarmUpCount(int count) {
+        Q_D(WidgetActionContext);
+        d->warmUpCount = qMax(0, count);
+        d->scheduleWarmUp();
+    }
+
+    QHash<QString, int> WidgetActionContext::menuOpenCounts() const {
+        Q_D(const WidgetActionContext);
+        return d->openCounts;
+    }
+
+    void WidgetActionContext::setMenuOpenCounts(const QHash<QString, int> &counts) {
+        Q_D(WidgetActionContext);
+        d->openCounts = counts;
+        d->scheduleWarmUp();
+    }
+
+    int WidgetActionContext::hiddenWidgetReleaseTimeout() const {
+        Q_D(const WidgetActionContext);
+        return d->hiddenWidgetReleaseTimeout;
+    }
+
+    void WidgetActionContext::setHiddenWidgetReleaseTimeout(int msecs) {
+        Q_D(WidgetActionContext);
+        d->hiddenWidgetReleaseTimeout = msecs;
+        for (const auto &item : std::as_const(d->items)) {
+            if (auto widgetAction = item.widgetAction())
+                widgetAction->releaseTimeout = msecs;
+        }
     }
 
     QAction *WidgetActionContext::action(const QString &id) const {
@@ -151,7 +760,7 @@ namespace QAK {
 
     void WidgetActionContext::addAction(const QString &id, QAction *action) {
         Q_D(WidgetActionContext);
-        d->items[id] = ActionItem(action);
+        d->setItem(id, ActionItem(action));
     }
 
     QList<QWidget *> WidgetActionContext::widgets(const QString &id) const {
@@ -160,13 +769,18 @@ namespace QAK {
         if (it == d->items.end()) {
             return {};
         }
-        return it->widgetAction()->createdWidgets();
+        if (auto widgetAction = it->widgetAction()) {
+            return widgetAction->realizedWidgets();
+        }
+        return {};
     }
 
     void WidgetActionContext::addWidgetFactory(const QString &id,
                                                std::function<QWidget *(QWidget *)> fac) {
         Q_D(WidgetActionContext);
-        d->items[id] = ActionItem(std::move(fac), id);
+        ActionItem item(std::move(fac), id);
+        item.widgetAction()->releaseTimeout = d->hiddenWidgetReleaseTimeout;
+        d->setItem(id, item);
     }
 
     QMenu *WidgetActionContext::menu(const QString &id) const {
@@ -180,7 +794,7 @@ namespace QAK {
 
     void WidgetActionContext::addMenu(const QString &id, QMenu *menu) {
         Q_D(WidgetActionContext);
-        d->items[id] = ActionItem(menu, false);
+        d->setItem(id, ActionItem(menu, false));
     }
 
     QMenuBar *WidgetActionContext::menuBar(const QString &id) const {
@@ -194,7 +808,7 @@ namespace QAK {
 
     void WidgetActionContext::addMenuBar(const QString &id, QMenuBar *menuBar) {
         Q_D(WidgetActionContext);
-        d->items[id] = ActionItem(menuBar);
+        d->setItem(id, ActionItem(menuBar));
     }
 
     QToolBar *WidgetActionContext::toolBar(const QString &id) const {
@@ -208,12 +822,12 @@ namespace QAK {
 
     void WidgetActionContext::addToolBar(const QString &id, QToolBar *toolBar) {
         Q_D(WidgetActionContext);
-        d->items[id] = ActionItem(toolBar);
+        d->setItem(id, ActionItem(toolBar));
     }
 
     void WidgetActionContext::remove(const QString &id) {
         Q_D(WidgetActionContext);
-        d->items.remove(id);
+        d->removeItem(id);
     }
 
     void WidgetActionContext::updateElement(ActionElement element) {
@@ -223,8 +837,31 @@ namespace QAK {
                 d->updateLayouts();
                 break;
             case AE_Texts:
+                d->updateObjects(WidgetActionContextPrivate::Text, {});
+                break;
+            case AE_Keymap:
+                d->updateObjects(WidgetActionContextPrivate::Keymap, {});
+                break;
+            case AE_Icons:
+                d->updateObjects(WidgetActionContextPrivate::Icon, {});
+                break;
+        }
+    }
+
+    void WidgetActionContext::updateActions(ActionElement element, const QStringList &ids) {
+        Q_D(WidgetActionContext);
+        switch (element) {
+            case AE_Texts:
+                d->updateObjects(WidgetActionContextPrivate::Text, ids);
+                break;
             case AE_Keymap:
+                d->updateObjects(WidgetActionContextPrivate::Keymap, ids);
+                break;
             case AE_Icons:
+                d->updateObjects(WidgetActionContextPrivate::Icon, ids);
+                break;
+            default:
+                updateElement(element);
                 break;
         }
     }
@@ -1,6 +1,7 @@
 #ifndef WIDGETACTIONCONTEXT_H
 #define WIDGETACTIONCONTEXT_H
 
+#include <QtCore/QHash>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QToolBar>
@@ -22,6 +23,13 @@ namespace QAK {
         enum Attribute {
             AttributeDisabled = 0x0,
             UpdateToolTipWithDescription = 0x1,
+            /// Populates each submenu when it is about to be shown for the first time after a
+            /// layout update.
+            LazySubmenus = 0x2,
+            /// Shares one action per id with the other contexts of the registry that have this
+            /// attribute, the signals of a shared action are emitted by the context of the active
+            /// window. Applies to the actions created afterwards.
+            SharedActions = 0x4,
         };
         Q_DECLARE_FLAGS(Attributes, Attribute)
 
@@ -29,10 +37,27 @@ namespace QAK {
         void setAttribute(Attribute attr, bool on = true);
         void setAttributes(Attributes attrs);
 
+        /// Returns the number of the most opened lazy submenus populated ahead while the event
+        /// loop is idle, 0 by default.
+        int warmUpCount() const;
+        void setWarmUpCount(int count);
+
+        /// Returns how many times each lazy submenu has been opened, which decides the warm-up
+        /// order and can be restored in the next session.
+        QHash<QString, int> menuOpenCounts() const;
+        void setMenuOpenCounts(const QHash<QString, int> &counts);
+
+        /// Returns the time in milliseconds after which a factory widget hidden with its container
+        /// is destroyed, it is created again when shown. Negative keeps the widgets, the default.
+        int hiddenWidgetReleaseTimeout() const;
+        void setHiddenWidgetReleaseTimeout(int msecs);
+
     public:
         QAction *action(const QString &id) const;
         void addAction(const QString &id, QAction *action);
 
+        /// Returns the widgets created by the factory of \a id, a widget is only created when the
+        /// container showing it is shown.
         QList<QWidget *> widgets(const QString &id) const;
         void addWidgetFactory(const QString &id, std::function<QWidget *(QWidget *)> fac);
 
@@ -54,12 +79,15 @@ namespace QAK {
 
     protected:
         void updateElement(ActionElement element) override;
+        void updateActions(ActionElement element, const QStringList &ids) override;
 
     protected:
         virtual QAction *createAction(const QString &id, QObject *parent) const;
         virtual QMenu *createSubMenu(const QString &id, QWidget *parent) const;
 
         friend class ActionRegistry;
+        friend class WidgetActionContextPrivate;
+        friend class WidgetSharedActionPool;
     };
 
 }
@@ -0,0 +1,272 @@
+#ifndef WIDGETACTIONCONTEXT_P_H
+#define WIDGETACTIONCONTEXT_P_H
+
+//
+//  W A R N I N G !!!
+//  -----------------
+//
+// This file is not part of the QActionKit API. It is used purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or may even be removed.
+//
+
+#include <optional>
+
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QWidgetAction>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKCore/private/actioncontext_p.h>
+#include <QAKWidgets/widgetactioncontext.h>
+
+namespace QAK {
+
+    class WidgetAction;
+
+    // Stands for a factory widget in a container, the widget is created when the placeholder is
+    // shown for the first time and may be released again while it is hidden
+    class WidgetActionPlaceholder : public QWidget {
+    public:
+        explicit WidgetActionPlaceholder(WidgetAction *action, QWidget *parent = nullptr);
+        ~WidgetActionPlaceholder() override;
+
+        inline QWidget *widget() const {
+            return w;
+        }
+
+        void realize();
+        void release();
+
+        QSize sizeHint() const override;
+
+    protected:
+        void showEvent(QShowEvent *event) override;
+        void hideEvent(QHideEvent *event) override;
+
+        WidgetAction *action;
+        QPointer<QWidget> w;
+        QSize lastSizeHint; // seeded on creation and kept after a release so that the layout does not jump
+        QTimer *releaseTimer = nullptr;
+    };
+
+    class WidgetAction : public QWidgetAction {
+    public:
+        explicit WidgetAction(std::function<QWidget *(QWidget *)> fac, QObject *parent = nullptr)
+            : QWidgetAction(parent), fac(std::move(fac)) {
+        }
+
+        inline QList<QWidget *> createdWidgets() const {
+            return QWidgetAction::createdWidgets();
+        }
+
+        // The factory widgets that currently exist
+        QList<QWidget *> realizedWidgets() const;
+
+        int releaseTimeout = -1; // negative keeps the hidden widgets
+
+        // The size hint of the factory widget, measured once on a throwaway widget so that the
+        // placeholders have a size before they are realized
+        QSize initialSizeHint(QWidget *parent);
+
+    protected:
+        QWidget *createWidget(QWidget *parent) override {
+            return new WidgetActionPlaceholder(this, parent);
+        }
+
+        std::function<QWidget *(QWidget *)> fac;
+        std::optional<QSize> measuredSizeHint;
+
+        friend class ActionItem;
+        friend class WidgetActionPlaceholder;
+    };
+
+    // A registered object, the owned ones are deleted by the context when they are replaced or
+    // removed, copies never delete anything.
+    struct ActionItem {
+        enum Type {
+            Action,
+            Menu,
+            MenuBar,
+            ToolBar,
+            Widget,
+        };
+        Type t;
+        QPointer<QObject> o;
+        bool owned;
+
+        QAction *action() const {
+            if (t == Action)
+                return static_cast<QAction *>(o.data());
+            return nullptr;
+        }
+
+        QMenu *menu() const {
+            if (t == Menu)
+                return static_cast<QMenu *>(o.data());
+            return nullptr;
+        }
+
+        QMenuBar *menuBar() const {
+            if (t == MenuBar)
+                return static_cast<QMenuBar *>(o.data());
+            return nullptr;
+        }
+
+        QToolBar *toolBar() const {
+            if (t == ToolBar)
+                return static_cast<QToolBar *>(o.data());
+            return nullptr;
+        }
+
+        WidgetAction *widgetAction() const {
+            if (t == Widget)
+                return static_cast<WidgetAction *>(o.data());
+            return nullptr;
+        }
+
+        // The widget whose actions are built from the layouts of the id
+        QWidget *container() const {
+            if (t == Menu || t == MenuBar || t == ToolBar)
+                return static_cast<QWidget *>(o.data());
+            return nullptr;
+        }
+
+        ActionItem() : t(Type(0)), o(nullptr), owned(false) {
+        }
+        ActionItem(QAction *a) : t(Action), o(a), owned(false) {
+        }
+        ActionItem(QMenu *m, bool own = true) : t(Menu), o(m), owned(own) {
+        }
+        ActionItem(QMenuBar *mb) : t(MenuBar), o(mb), owned(false) {
+        }
+        ActionItem(QToolBar *tb) : t(ToolBar), o(tb), owned(false) {
+        }
+        ActionItem(std::function<QWidget *(QWidget *)> fac, const QString &id)
+            : t(Widget), o(new WidgetAction(std::move(fac))), owned(true) {
+            Q_UNUSED(id);
+        }
+    };
+
+    class WidgetActionContextPrivate;
+
+    // The actions shared by the contexts of a registry with the SharedActions attribute, reference
+    // counted by the contexts. The pool is a child of the registry, and an action is only shared
+    // by the contexts of the same class since createAction() decides its properties.
+    class WidgetSharedActionPool : public QObject {
+        Q_OBJECT
+    public:
+        explicit WidgetSharedActionPool(ActionRegistry *registry);
+        ~WidgetSharedActionPool() override;
+
+        static WidgetSharedActionPool *of(ActionRegistry *registry);
+
+        QAction *acquire(const QString &id, WidgetActionContext *context);
+        void release(QAction *action, WidgetActionContext *context);
+
+    protected:
+        bool eventFilter(QObject *watched, QEvent *event) override;
+
+        struct Key {
+            QString id;
+            const QMetaObject *creator;
+
+            inline bool operator==(const Key &other) const {
+                return id == other.id && creator == other.creator;
+            }
+            friend inline size_t qHash(const Key &key, size_t seed = 0) {
+                return qHashMulti(seed, key.id, key.creator);
+            }
+        };
+        struct Entry {
+            QAction *action = nullptr;
+            QList<WidgetActionContext *> users;
+        };
+        QHash<Key, Entry> entries;
+        QHash<QAction *, Key> keys;
+
+        QPointer<QWidget> inputWidget; // the widget that received the last mouse or key press
+
+        // The user owning the widget of the last input, otherwise the one owning the active
+        // window, otherwise the one that acquired the action first
+        WidgetActionContext *route(QAction *action) const;
+    };
+
+    class WidgetActionContextPrivate : public ActionContextPrivate {
+        Q_DECLARE_PUBLIC(WidgetActionContext)
+    public:
+        WidgetActionContextPrivate() = default;
+        ~WidgetActionContextPrivate();
+
+        WidgetActionContext::Attributes attrs;
+        QMap<QString, ActionItem> items;
+
+        void setItem(const QString &id, const ActionItem &item);
+        void removeItem(const QString &id);
+
+        enum ActionProperty { Text = 1, Icon = 2, Keymap = 4, All = Text | Icon | Keymap };
+        void applyProperties(const QString &id, QAction *action, int properties) const;
+        void applyProperties(const QString &id, QMenu *menu, int properties) const;
+
+        // Builder state, the actions and submenus are created once per id and shared by all
+        // containers showing the id
+        QHash<QString, QAction *> createdActions;
+        QHash<QString, QMenu *> createdMenus;
+        QHash<QWidget *, QList<QAction *>> managedActions; // container -> built actions in order
+        QSet<QAction *> builtSeparators;                   // separators and spacers of the builder
+
+        // The objects refreshed from the registry: the created actions and submenus, and the
+        // factory actions with their widgets. The registered actions and menus are left to the
+        // application.
+        QMultiHash<QString, QObject *> objectsById;
+        void indexObject(const QString &id, QObject *object);
+        void unindexObject(const QString &id, QObject *object);
+        void updateObjects(int properties, const QStringList &ids);
+
+        // Shared actions, also present in createdActions
+        QPointer<WidgetSharedActionPool> sharedPool;
+        QSet<QAction *> sharedActions;
+        void releaseAction(QAction *action);
+        void dropSharedAction(const QString &id, QAction *action);
+        void registryChanged() override;
+        bool ownsWidget(const QWidget *widget) const;
+        bool ownsWindow(const QWidget *window) const;
+
+        // Lazy submenus
+        QHash<QMenu *, QString> lazyMenus; // -> id
+        QSet<QMenu *> dirtyMenus;          // to populate on the next show
+        QHash<QString, int> openCounts;
+        int warmUpCount = 0;
+
+        int hiddenWidgetReleaseTimeout = -1;
+        QTimer *warmUpTimer = nullptr;
+        QList<QPointer<QMenu>> warmUpQueue;
+
+        struct BuildState {
+            ActionLayouts layouts;
+            QSet<QString> usedActions;
+            QSet<QString> usedMenus;
+            QSet<QWidget *> builtContainers;
+            QStringList path; // the menu ids being built, to break cycles
+        };
+
+        void updateLayouts();
+        void buildContainer(const QString &id, QWidget *container, BuildState &state);
+        QAction *actionFor(const QString &id, BuildState &state);
+        QMenu *menuFor(const QString &id, BuildState &state);
+        void patchActions(QWidget *container, const QList<QAction *> &desired);
+        void trackContainer(QWidget *container);
+        void forgetAction(QAction *action);
+
+        void markDirty(const QString &id, QMenu *menu);
+        void populateMenu(QMenu *menu);
+        void scheduleWarmUp();
+        void connectAction(const QString &id, QAction *action);
+    };
+
+}
+
+#endif // WIDGETACTIONCONTEXT_P_H
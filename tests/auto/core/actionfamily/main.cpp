@@ -1,8 +1,11 @@
 #include <set>
 
 #include <QtTest/QtTest>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QTemporaryDir>
 
 #include <QAKCore/actionfamily.h>
+#include <QAKCore/private/actionicon_p.h>
 
 static std::set<QString> stringListToSet(const QStringList &list) {
     std::set<QString> set;
@@ -196,6 +199,187 @@ private Q_SLOTS:
         QCOMPARE(family.icon("theme1", "theme1.icon4").url(),
                  QUrl("file:///path/to/theme1.icon4.first"));
     }
+
+    void testIconThemeInheritance() {
+        QAK::ActionFamily family;
+        family.addIconManifest(":/config.json");
+
+        // Declared in manifest
+        QCOMPARE(family.iconThemeFallback("theme2"), QString("theme1"));
+        QCOMPARE(family.iconThemeChain("theme2"), QStringList({"theme2", "theme1"}));
+        QCOMPARE(family.resolveIcon("theme2", "theme2.icon1").url(),
+                 QUrl("file:///path/to/theme2.icon1.icon"));
+        QCOMPARE(family.resolveIcon("theme2", "theme1.icon2").url(),
+                 QUrl("file:///path/to/theme1.icon2.icon"));
+        QVERIFY(family.resolveIcon("theme2", "theme3.icon1").url().isEmpty());
+
+        // Declared in code
+        family.setIconThemeFallback("dark", "theme2");
+        QCOMPARE(family.iconThemeChain("dark"), QStringList({"dark", "theme2", "theme1"}));
+        QCOMPARE(family.actionIcon("dark", "theme1.icon3").url(),
+                 QUrl("file:///path/to/theme1.icon3.icon"));
+
+        // Invalidated by changes of a base layer
+        family.addIcon("theme2", "theme1.icon3",
+                       QAK::ActionIcon(QUrl("file:///path/to/theme2.icon3.override")));
+        QCOMPARE(family.actionIcon("dark", "theme1.icon3").url(),
+                 QUrl("file:///path/to/theme2.icon3.override"));
+        family.removeIcon("theme2", "theme1.icon3");
+        QCOMPARE(family.actionIcon("dark", "theme1.icon3").url(),
+                 QUrl("file:///path/to/theme1.icon3.icon"));
+
+        // Invalidated by changes of the chain
+        family.setIconThemeFallback("dark", "theme3");
+        QCOMPARE(family.iconThemeChain("dark"), QStringList({"dark", "theme3"}));
+        QVERIFY(family.actionIcon("dark", "theme1.icon3").url().isEmpty());
+
+        // Cycles are cut
+        family.setIconThemeFallback("theme1", "theme2");
+        QCOMPARE(family.iconThemeChain("theme2"), QStringList({"theme2", "theme1"}));
+
+        family.removeIconManifest(":/config.json");
+        QVERIFY(family.resolveIcon("theme2", "theme2.icon1").url().isEmpty());
+    }
+
+    void testIconDeduplication() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const auto writeFile = [&](const QString &name, const QByteArray &data) {
+            QFile file(dir.filePath(name));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(data);
+        };
+        const QByteArray glyph = "<svg xmlns=\"http://www.w3.org/2000/svg\"/>";
+        QVERIFY(QDir(dir.path()).mkpath("light"));
+        QVERIFY(QDir(dir.path()).mkpath("dark"));
+        writeFile("light/save.svg", glyph);
+        writeFile("dark/save.svg", glyph);
+        writeFile("dark/open.svg", glyph + " ");
+
+        const QString fileName = dir.filePath("manifest.json");
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(R"({
+            "themes": [
+                { "id": "light", "icons": [ { "id": "save", "icon": "light/save.svg" } ] },
+                { "id": "dark", "icons": [
+                    { "id": "save", "icon": "dark/save.svg" },
+                    { "id": "open", "icon": "dark/open.svg" }
+                ] }
+            ]
+        })");
+        file.close();
+
+        QAK::ActionFamily family;
+        family.setIconDeduplicationEnabled(true);
+        family.addIconManifest(fileName);
+
+        const auto light = family.icon("light", "save");
+        const auto dark = family.icon("dark", "save");
+        QCOMPARE(light.url(), QUrl::fromLocalFile(dir.filePath("light/save.svg")));
+        QCOMPARE(dark.url(), light.url());
+        QCOMPARE(family.icon("dark", "open").url(),
+                 QUrl::fromLocalFile(dir.filePath("dark/open.svg")));
+
+        const auto statistics = family.iconDeduplicationStatistics();
+        QCOMPARE(statistics.fileCount, 3);
+        QCOMPARE(statistics.uniqueFileCount, 2);
+        QCOMPARE(statistics.savedBytes, qint64(glyph.size()));
+
+        // Identical glyphs share one QIcon within a family
+        QCOMPARE(dark.icon().cacheKey(), light.icon().cacheKey());
+        {
+            QAK::ActionFamily other;
+            other.addIconManifest(fileName);
+            QVERIFY(other.icon("light", "save").icon().cacheKey() != light.icon().cacheKey());
+        }
+
+        // A changed file is hashed again
+        writeFile("light/save.svg", glyph + "  ");
+        family.addIconManifest(fileName);
+        QCOMPARE(family.icon("dark", "save").url(),
+                 QUrl::fromLocalFile(dir.filePath("dark/save.svg")));
+
+        // The files of a removed manifest are no longer canonical
+        const QString otherFileName = dir.filePath("other.json");
+        QFile otherFile(otherFileName);
+        QVERIFY(otherFile.open(QIODevice::WriteOnly));
+        otherFile.write(R"({
+            "themes": [ { "id": "other", "icons": [ { "id": "open", "icon": "dark/save.svg" } ] } ]
+        })");
+        otherFile.close();
+        family.addIconManifest(otherFileName);
+        QCOMPARE(family.icon("other", "open").url(),
+                 QUrl::fromLocalFile(dir.filePath("dark/save.svg")));
+        writeFile("light/save.svg", glyph);
+        family.removeAllIcons();
+        family.addIconManifest(fileName);
+        family.addIconManifest(otherFileName);
+        QCOMPARE(family.icon("other", "open").url(),
+                 QUrl::fromLocalFile(dir.filePath("light/save.svg")));
+        family.removeIconManifest(fileName);
+        QCOMPARE(family.icon("other", "open").url(),
+                 QUrl::fromLocalFile(dir.filePath("dark/save.svg")));
+    }
+
+    void benchmarkLargeManifest() {
+        static constexpr int themeCount = 4;
+        static constexpr int iconCount = 5000;
+
+        // Themes of a large manifest referring to the same files
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QJsonArray themesArr;
+        for (int t = 0; t < themeCount; ++t) {
+            QJsonArray iconsArr;
+            for (int i = 0; i < iconCount; ++i) {
+                iconsArr.append(QJsonObject({
+                    {"id",   QString("icon%1").arg(i)},
+                    {"icon",
+                     QJsonObject({
+                         {"unchecked",
+                          QJsonObject({
+                              {"enabled", QString("icon%1.svg").arg(i)},
+                              {"disabled", QString("icon%1_disabled.svg").arg(i)},
+                          })},
+                     })                               },
+                }));
+            }
+            themesArr.append(QJsonObject({
+                {"id",    QString("theme%1").arg(t)},
+                {"icons", iconsArr                 },
+            }));
+        }
+        const QString fileName = dir.filePath("manifest.json");
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QJsonDocument(QJsonObject({{"themes", themesArr}})).toJson());
+        file.close();
+
+        const auto pool = QAK::ActionIconUrlPool::instance();
+        const int poolSize = pool->size();
+        QBENCHMARK {
+            QAK::ActionFamily family;
+            family.addIconManifest(fileName);
+            QCOMPARE(family.iconIds("theme0").size(), iconCount);
+        }
+
+        // The urls are evicted with the last icon referring to them
+        QCOMPARE(pool->size(), poolSize);
+
+        {
+            QAK::ActionFamily family;
+            family.addIconManifest(fileName);
+            // The themes share the interned urls of the two states of each icon
+            QCOMPARE(pool->size() - poolSize, 2 * iconCount);
+            const auto first = family.icon("theme0", "icon42");
+            const auto last = family.icon(QString("theme%1").arg(themeCount - 1), "icon42");
+            QCOMPARE(last.url(), first.url());
+            QCOMPARE(last.url(false), first.url(false));
+            QCOMPARE(first.url(false), QUrl::fromLocalFile(dir.filePath("icon42_disabled.svg")));
+        }
+        QCOMPARE(pool->size(), poolSize);
+    }
 };
 
 QTEST_MAIN(Test)
@@ -1,5 +1,32 @@
+#include <set>
+
 #include <QtTest/QtTest>
 
+#include <QAKCore/actioncontext.h>
+#include <QAKCore/actionregistry.h>
+
+#include "testextension.h"
+
+static std::set<QString> stringListToSet(const QStringList &list) {
+    std::set<QString> set;
+    for (const auto &str : list) {
+        set.insert(str);
+    }
+    return set;
+}
+
+class TestActionContext : public QAK::ActionContext {
+public:
+    void updateElement(QAK::ActionElement element) override {
+        updates.append({element, {}});
+    }
+    void updateActions(QAK::ActionElement element, const QStringList &ids) override {
+        updates.append({element, stringListToSet(ids)});
+    }
+
+    QList<QPair<QAK::ActionElement, std::set<QString>>> updates;
+};
+
 class Test : public QObject {
     Q_OBJECT
 public:
@@ -18,7 +45,196 @@ private Q_SLOTS:
     void cleanup() {
     }
 
-    void test() {
+    void testShortcutIndex() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+
+        QCOMPARE(registry.shortcutActions(QKeySequence("Ctrl+S")), QStringList({"test.save"}));
+        QCOMPARE(registry.shortcutPrefixActions(QKeySequence("Ctrl+K")),
+                 QStringList({"test.saveAll"}));
+        QVERIFY(!registry.isShortcutConflicting(QKeySequence("Ctrl+S")));
+        QVERIFY(registry.isShortcutAmbiguous(QKeySequence("Ctrl+K")));
+        QVERIFY(registry.isShortcutAmbiguous(QKeySequence("Ctrl+K, Ctrl+S")));
+        QVERIFY(!registry.isShortcutAmbiguous(QKeySequence("Ctrl+O")));
+        QVERIFY(registry.conflictingShortcuts().isEmpty());
+
+        // Override a single action
+        registry.setShortcuts("test.open", QList<QKeySequence>({QKeySequence("Ctrl+S")}));
+        QCOMPARE(stringListToSet(registry.shortcutActions(QKeySequence("Ctrl+S"))),
+                 stringListToSet({"test.save", "test.open"}));
+        QVERIFY(registry.isShortcutConflicting(QKeySequence("Ctrl+S")));
+        QVERIFY(registry.shortcutActions(QKeySequence("Ctrl+O")).isEmpty());
+        QCOMPARE(registry.conflictingShortcuts(), QList<QKeySequence>({QKeySequence("Ctrl+S")}));
+
+        // Replace the keymap
+        registry.setShortcutsFamily({
+            {"test.commandPalette", QList<QKeySequence>({QKeySequence("Ctrl+Shift+P")})},
+        });
+        QCOMPARE(registry.shortcutActions(QKeySequence("Ctrl+O")), QStringList({"test.open"}));
+        QVERIFY(!registry.isShortcutConflicting(QKeySequence("Ctrl+S")));
+        QVERIFY(registry.shortcutActions(QKeySequence("Ctrl+K")).isEmpty());
+        QVERIFY(!registry.isShortcutAmbiguous(QKeySequence("Ctrl+K, Ctrl+S")));
+        QCOMPARE(registry.shortcutActions(QKeySequence("Ctrl+Shift+P")),
+                 QStringList({"test.commandPalette"}));
+
+        // Reset
+        registry.resetShortcuts();
+        QCOMPARE(registry.shortcutActions(QKeySequence("Ctrl+K")),
+                 QStringList({"test.commandPalette"}));
+        QVERIFY(registry.shortcutActions(QKeySequence("Ctrl+Shift+P")).isEmpty());
+    }
+
+    void testKeymap() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+
+        QCOMPARE(registry.actionShortcuts("test.save"), QList<QKeySequence>({QKeySequence("Ctrl+S")}));
+        registry.setShortcuts("test.save", QList<QKeySequence>());
+        QVERIFY(registry.actionShortcuts("test.save").isEmpty());
+
+        auto exported = registry.exportKeymap();
+        QCOMPARE(exported.size(), 4);
+        QJsonObject saveEntry;
+        for (const auto &entry : std::as_const(exported)) {
+            if (entry.toObject().value("id") == "test.save")
+                saveEntry = entry.toObject();
+        }
+        QCOMPARE(saveEntry, QJsonObject({
+                                {"id", "test.save"},
+                                {"keys", QJsonArray()},
+                            }));
+
+        QAK::ActionRegistry other;
+        other.setExtensions({testActionExtension()});
+        other.importKeymap(exported);
+        QCOMPARE(other.exportKeymap(), exported);
+
+        // Entries equal to the defaults do not produce overrides
+        QCOMPARE(other.shortcutsFamily(), QAK::ActionFamily::ShortcutsFamily({
+                                              {"test.save", QList<QKeySequence>()},
+                                          }));
+    }
+
+    void testTargetedUpdate() {
+        using Update = QPair<QAK::ActionElement, std::set<QString>>;
+
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        TestActionContext context;
+        registry.addContext(&context);
+
+        // Untargeted after the extensions have changed
+        registry.updateContext(QAK::AE_Keymap);
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Keymap, {}}}));
+        context.updates.clear();
+
+        registry.setShortcuts("test.save", QList<QKeySequence>());
+        registry.setShortcuts("test.open", QList<QKeySequence>({QKeySequence("Ctrl+Shift+O")}));
+        registry.updateContext(QAK::AE_Keymap);
+        QCOMPARE(context.updates, QList<Update>({
+                                      {QAK::AE_Keymap, {"test.save", "test.open"}},
+        }));
+        context.updates.clear();
+
+        // Nothing tracked, fall back to a full update
+        registry.updateContext(QAK::AE_Keymap);
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Keymap, {}}}));
+        context.updates.clear();
+
+        registry.updateContext(QAK::AE_Icons);
+        context.updates.clear();
+        registry.setIcon("test.save", QAK::ActionIcon());
+        registry.updateContext(QAK::AE_Icons);
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Icons, {"test.save"}}}));
+        context.updates.clear();
+
+        // The base icons affect every action
+        registry.setIcon("test.save", QAK::ActionIcon());
+        registry.removeAllIcons();
+        registry.updateContext(QAK::AE_Icons);
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Icons, {}}}));
+    }
+
+    void testPatchLayouts() {
+        using Update = QPair<QAK::ActionElement, std::set<QString>>;
+        using Entry = QAK::ActionLayoutEntry;
+
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        TestActionContext context;
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+        context.updates.clear();
+
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry({}, Entry::Separator), Entry("test.saveAll")}},
+            {"test.open", {}}, // unchanged
+        });
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.save"),
+                 QVector<Entry>({Entry("test.open"), Entry({}, Entry::Separator), Entry("test.saveAll")}));
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Layouts, {"test.save"}}}));
+        context.updates.clear();
+
+        // A child closing a cycle is skipped
+        registry.patchLayouts({
+            {"test.saveAll", {Entry("test.save"), Entry("test.commandPalette")}},
+        });
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.saveAll"),
+                 QVector<Entry>({Entry("test.commandPalette")}));
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.save").size(), 3);
+    }
+
+    void testUsage() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QVERIFY(registry.mostUsedActions(10).isEmpty());
+
+        for (int i = 0; i < 3; ++i) {
+            registry.recordUsage("test.save");
+        }
+        registry.recordUsage("test.open");
+        QCOMPARE(registry.mostUsedActions(10), QStringList({"test.save", "test.open"}));
+        QCOMPARE(registry.mostUsedActions(1), QStringList({"test.save"}));
+        QVERIFY(qAbs(registry.usageScore("test.save") - 3) < 0.01);
+        QCOMPARE(registry.usageScore("test.commandPalette"), 0.0);
+        const auto scores = registry.usageScores();
+        QCOMPARE(scores.size(), 2);
+        QVERIFY(qAbs(scores.value("test.open") - 1) < 0.01);
+
+        // The ids no longer registered are neither ranked nor saved
+        registry.recordUsage("test.removed");
+        QVERIFY(registry.usageScore("test.removed") > 0);
+        QCOMPARE(registry.mostUsedActions(10), QStringList({"test.save", "test.open"}));
+
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(registry.saveUsage(&buffer));
+        buffer.close();
+
+        QAK::ActionRegistry other;
+        buffer.open(QIODevice::ReadOnly);
+        QVERIFY(other.loadUsage(&buffer));
+        QCOMPARE(other.usageScores().size(), 2);
+        QCOMPARE(other.usageScore("test.removed"), 0.0);
+        QVERIFY(other.mostUsedActions(10).isEmpty());
+        other.setExtensions({testActionExtension()});
+        QCOMPARE(other.mostUsedActions(10), QStringList({"test.save", "test.open"}));
+        QVERIFY(qAbs(other.usageScore("test.open") - 1) < 0.01);
+
+        // The scores so far are kept when the half life changes
+        other.setUsageHalfLife(3600);
+        QCOMPARE(other.usageHalfLife(), 3600);
+        QVERIFY(qAbs(other.usageScore("test.save") - 3) < 0.01);
+
+        other.clearUsage();
+        QVERIFY(other.mostUsedActions(10).isEmpty());
+
+        QBuffer invalid;
+        invalid.setData("garbage");
+        invalid.open(QIODevice::ReadOnly);
+        QVERIFY(!registry.loadUsage(&invalid));
+        QCOMPARE(registry.mostUsedActions(10).size(), 2);
     }
 };
 
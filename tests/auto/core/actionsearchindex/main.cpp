@@ -0,0 +1,69 @@
+#include <QtTest/QtTest>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKCore/actionsearchindex.h>
+
+#include "testextension.h"
+
+static QStringList resultIds(const QList<QAK::ActionSearchIndex::Result> &results) {
+    QStringList ids;
+    for (const auto &result : results) {
+        ids.append(result.id);
+    }
+    return ids;
+}
+
+class Test : public QObject {
+    Q_OBJECT
+public:
+    explicit Test(QObject *parent = nullptr) : QObject(parent) {
+    }
+
+private Q_SLOTS:
+    void testSearch() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::ActionSearchIndex index;
+        registry.addContext(&index);
+        QCOMPARE(index.size(), 4);
+
+        // The exact text ranks first
+        QCOMPARE(resultIds(index.search("save")), QStringList({"test.save", "test.saveAll"}));
+        QCOMPARE(resultIds(index.search("SAVE", 1)), QStringList({"test.save"}));
+
+        // Every term must match, the actions matching all terms as substrings first
+        QCOMPARE(resultIds(index.search("sa al")),
+                 QStringList({"test.saveAll", "test.commandPalette"}));
+
+        // Subsequence
+        QCOMPARE(resultIds(index.search("cmdp")), QStringList({"test.commandPalette"}));
+
+        // Id
+        QCOMPARE(resultIds(index.search("test.open")), QStringList({"test.open"}));
+
+        QVERIFY(index.search("xyz").isEmpty());
+        QVERIFY(index.search("  ").isEmpty());
+    }
+
+    void testUpdate() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::ActionSearchIndex index;
+        registry.addContext(&index);
+        QCOMPARE(index.size(), 4);
+
+        // Re-indexed in place
+        registry.updateContext(QAK::AE_Texts, {"test.open", "test.unknown"});
+        QCOMPARE(index.size(), 4);
+        QCOMPARE(resultIds(index.search("open")), QStringList({"test.open"}));
+
+        registry.setExtensions({});
+        registry.updateContext(QAK::AE_Texts);
+        QCOMPARE(index.size(), 0);
+        QVERIFY(index.search("open").isEmpty());
+    }
+};
+
+QTEST_MAIN(Test)
+
+#include "main.moc"
@@ -0,0 +1,231 @@
+#include <QtTest/QtTest>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKCore/actionshortcutdispatcher.h>
+
+#include "testextension.h"
+
+static inline QKeyCombination key(Qt::KeyboardModifiers modifiers, Qt::Key k) {
+    return QKeyCombination(modifiers, k);
+}
+
+// Stands for a focus widget, which may claim a key in the override event like a text field
+class KeyReceiver : public QObject {
+public:
+    bool event(QEvent *event) override {
+        switch (event->type()) {
+            case QEvent::ShortcutOverride: {
+                overrides++;
+                auto e = static_cast<QKeyEvent *>(event);
+                if (e->keyCombination() == claimed)
+                    e->accept();
+                return true;
+            }
+            case QEvent::KeyPress:
+                keyPresses++;
+                return true;
+            default:
+                break;
+        }
+        return QObject::event(event);
+    }
+
+    QKeyCombination claimed;
+    int overrides = 0;
+    int keyPresses = 0;
+};
+
+class Test : public QObject {
+    Q_OBJECT
+public:
+    explicit Test(QObject *parent = nullptr) : QObject(parent) {
+    }
+
+private Q_SLOTS:
+    void testChords() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::ActionShortcutDispatcher dispatcher;
+        dispatcher.setChordTimeout(-1);
+        registry.addContext(&dispatcher);
+        QSignalSpy triggered(&dispatcher, &QAK::ActionShortcutDispatcher::actionTriggered);
+
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S)));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.save");
+        // The dispatched actions count as used
+        QVERIFY(registry.usageScore("test.save") > 0);
+
+        // Unbound keys are not consumed
+        QVERIFY(!dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_P)));
+        QVERIFY(triggered.isEmpty());
+
+        // Chord
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_K)));
+        QVERIFY(dispatcher.isPending());
+        QCOMPARE(dispatcher.pendingKeys(), QKeySequence("Ctrl+K"));
+        const auto pendingActions = dispatcher.pendingActions();
+        QCOMPARE(QSet<QString>(pendingActions.begin(), pendingActions.end()),
+                 QSet<QString>({"test.commandPalette", "test.saveAll"}));
+        QVERIFY(triggered.isEmpty());
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S)));
+        QVERIFY(!dispatcher.isPending());
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.saveAll");
+
+        // A chord not continuing the sequence completes the prefix and is processed again
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_K)));
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_O)));
+        QCOMPARE(triggered.size(), 2);
+        QCOMPARE(triggered.at(0).at(0).toString(), "test.commandPalette");
+        QCOMPARE(triggered.at(1).at(0).toString(), "test.open");
+        triggered.clear();
+
+        // Timeout
+        dispatcher.setChordTimeout(10);
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_K)));
+        QTRY_VERIFY(!dispatcher.isPending());
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.commandPalette");
+    }
+
+    void testKeymapUpdate() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::ActionShortcutDispatcher dispatcher;
+        registry.addContext(&dispatcher);
+        QSignalSpy triggered(&dispatcher, &QAK::ActionShortcutDispatcher::actionTriggered);
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_O)));
+        triggered.clear();
+
+        // Patched by the targeted update
+        registry.setShortcuts("test.open", QList<QKeySequence>({QKeySequence("Ctrl+Shift+O")}));
+        registry.updateContext(QAK::AE_Keymap);
+        QVERIFY(!dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_O)));
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier | Qt::ShiftModifier, Qt::Key_O)));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.open");
+
+        // No chord is left once the longer binding is gone
+        registry.setShortcuts("test.saveAll", QList<QKeySequence>());
+        registry.updateContext(QAK::AE_Keymap);
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_K)));
+        QVERIFY(!dispatcher.isPending());
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.commandPalette");
+    }
+
+    void testScopes() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.setShortcuts("test.open", QList<QKeySequence>({QKeySequence("Ctrl+S")}));
+        QAK::ActionShortcutDispatcher dispatcher;
+        registry.addContext(&dispatcher);
+        QSignalSpy triggered(&dispatcher, &QAK::ActionShortcutDispatcher::actionTriggered);
+        QSignalSpy ambiguous(&dispatcher, &QAK::ActionShortcutDispatcher::actionAmbiguous);
+
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S)));
+        QVERIFY(triggered.isEmpty());
+        QCOMPARE(ambiguous.size(), 1);
+
+        // Scoped actions are only bound in their scope, and win over the unscoped ones
+        dispatcher.setScopeActions("editor", {"test.open"});
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S)));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.save");
+
+        QObject editor;
+        QObject child(&editor);
+        dispatcher.setObjectScope(&editor, "editor");
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S), &child));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.open");
+
+        dispatcher.setActiveScopes({"editor"});
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S)));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.open");
+
+        dispatcher.removeScope("editor");
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_S), &child));
+        QCOMPARE(ambiguous.size(), 2);
+    }
+
+    void testKeypad() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.setShortcuts("test.open", QList<QKeySequence>({
+                                               QKeySequence(Qt::ControlModifier | Qt::KeypadModifier | Qt::Key_1),
+                                               QKeySequence(Qt::ControlModifier | Qt::Key_1),
+                                           }));
+        QAK::ActionShortcutDispatcher dispatcher;
+        registry.addContext(&dispatcher);
+        QSignalSpy triggered(&dispatcher, &QAK::ActionShortcutDispatcher::actionTriggered);
+        QSignalSpy ambiguous(&dispatcher, &QAK::ActionShortcutDispatcher::actionAmbiguous);
+
+        // A binding with the keypad modifier is bound like the key events are looked up, the
+        // two bindings of the same key count once
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier | Qt::KeypadModifier, Qt::Key_1)));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.open");
+        QVERIFY(dispatcher.processKey(key(Qt::ControlModifier, Qt::Key_1)));
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.open");
+        QVERIFY(ambiguous.isEmpty());
+
+        // And unbound the same way by the targeted update
+        registry.setShortcuts("test.open", QList<QKeySequence>());
+        registry.updateContext(QAK::AE_Keymap);
+        QVERIFY(!dispatcher.processKey(key(Qt::ControlModifier | Qt::KeypadModifier, Qt::Key_1)));
+        QVERIFY(triggered.isEmpty());
+    }
+
+    void testShortcutOverride() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::ActionShortcutDispatcher dispatcher;
+        registry.addContext(&dispatcher);
+        QSignalSpy triggered(&dispatcher, &QAK::ActionShortcutDispatcher::actionTriggered);
+
+        KeyReceiver receiver;
+        receiver.installEventFilter(&dispatcher);
+
+        // The receiver sees the override first, the dispatcher accepts the keys it binds
+        QKeyEvent override(QEvent::ShortcutOverride, Qt::Key_S, Qt::ControlModifier);
+        override.setTimestamp(1);
+        QCoreApplication::sendEvent(&receiver, &override);
+        QCOMPARE(receiver.overrides, 1);
+        QVERIFY(override.isAccepted());
+
+        // The same event sent again, e.g. by another filter, is not forwarded twice
+        QCoreApplication::sendEvent(&receiver, &override);
+        QCOMPARE(receiver.overrides, 1);
+
+        QKeyEvent press(QEvent::KeyPress, Qt::Key_S, Qt::ControlModifier);
+        press.setTimestamp(1);
+        QCoreApplication::sendEvent(&receiver, &press);
+        QCOMPARE(triggered.size(), 1);
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.save");
+        QCOMPARE(receiver.keyPresses, 0);
+        QCoreApplication::sendEvent(&receiver, &press);
+        QVERIFY(triggered.isEmpty());
+
+        // An unbound key is left to the receiver
+        QKeyEvent unboundOverride(QEvent::ShortcutOverride, Qt::Key_P, Qt::ControlModifier);
+        unboundOverride.setTimestamp(2);
+        QCoreApplication::sendEvent(&receiver, &unboundOverride);
+        QVERIFY(!unboundOverride.isAccepted());
+        QKeyEvent unboundPress(QEvent::KeyPress, Qt::Key_P, Qt::ControlModifier);
+        unboundPress.setTimestamp(2);
+        QCoreApplication::sendEvent(&receiver, &unboundPress);
+        QCOMPARE(receiver.keyPresses, 1);
+        QVERIFY(triggered.isEmpty());
+
+        // A key claimed by the receiver is not dispatched
+        receiver.claimed = key(Qt::ControlModifier, Qt::Key_S);
+        QKeyEvent claimedOverride(QEvent::ShortcutOverride, Qt::Key_S, Qt::ControlModifier);
+        claimedOverride.setTimestamp(3);
+        QCoreApplication::sendEvent(&receiver, &claimedOverride);
+        QCOMPARE(receiver.overrides, 3);
+        QVERIFY(claimedOverride.isAccepted());
+        QKeyEvent claimedPress(QEvent::KeyPress, Qt::Key_S, Qt::ControlModifier);
+        claimedPress.setTimestamp(3);
+        QCoreApplication::sendEvent(&receiver, &claimedPress);
+        QCOMPARE(receiver.keyPresses, 2);
+        QVERIFY(triggered.isEmpty());
+    }
+};
+
+QTEST_MAIN(Test)
+
+#include "main.moc"
@@ -0,0 +1,126 @@
+#include <QtTest/QtTest>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKQuick/quickactioncontext.h>
+#include <QAKQuick/private/quickactionlayoutslistmodel_p.h>
+
+#include "testextension.h"
+
+using Model = QAK::QuickActionLayoutsListModel;
+using Entry = QAK::ActionLayoutEntry;
+
+static QStringList rowIds(const Model &model) {
+    QStringList ids;
+    for (int i = 0; i < model.rowCount(); ++i) {
+        ids.append(model.index(i).data(Model::IdRole).toString());
+    }
+    return ids;
+}
+
+class Test : public QObject {
+    Q_OBJECT
+public:
+    explicit Test(QObject *parent = nullptr) : QObject(parent) {
+    }
+
+private Q_SLOTS:
+    void testRows() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry({}, Entry::Separator), Entry("test.open"), Entry({}, Entry::Separator),
+                           Entry({}, Entry::Separator), Entry("test.saveAll"), Entry({}, Entry::Separator)}},
+        });
+        QAK::QuickActionContext context;
+        registry.addContext(&context);
+
+        Model model;
+        model.setContext(&context);
+        model.setId("test.save");
+
+        // The leading, adjacent and trailing separators are collapsed
+        QCOMPARE(rowIds(model), QStringList({"test.open", "", "test.saveAll"}));
+        QCOMPARE(model.index(1).data(Model::TypeRole).toInt(), int(Model::Separator));
+        QCOMPARE(model.index(0).data(Model::TextRole).toString(), "Open");
+        QCOMPARE(model.index(0).data(Model::ShortcutRole).toString(),
+                 QKeySequence("Ctrl+O").toString(QKeySequence::NativeText));
+
+        model.setActionEnabled("test.open", false);
+        QVERIFY(!model.index(0).data(Model::EnabledRole).toBool());
+    }
+
+    void testPatch() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry({}, Entry::Separator), Entry("test.saveAll")}},
+        });
+        QAK::QuickActionContext context;
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+
+        Model model;
+        model.setContext(&context);
+        model.setId("test.save");
+        QCOMPARE(model.rowCount(), 3);
+
+        QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+        QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy countChanged(&model, &Model::countChanged);
+
+        // Nothing changed in the node
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(inserted.count(), 0);
+        QCOMPARE(removed.count(), 0);
+
+        // Append
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry({}, Entry::Separator), Entry("test.saveAll"),
+                           Entry("test.commandPalette")}},
+        });
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(inserted.first().at(1).toInt(), 3);
+        QCOMPARE(inserted.first().at(2).toInt(), 3);
+        QCOMPARE(removed.count(), 0);
+        QCOMPARE(countChanged.count(), 1);
+
+        // Remove from the middle
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry("test.commandPalette")}},
+        });
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(removed.first().at(1).toInt(), 1);
+        QCOMPARE(removed.first().at(2).toInt(), 2);
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(rowIds(model), QStringList({"test.open", "test.commandPalette"}));
+        QCOMPARE(model.index(1).data(Model::TextRole).toString(), "Command Palette");
+        QCOMPARE(reset.count(), 0);
+    }
+
+    void testContextDestroyed() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open")}},
+        });
+        auto context = new QAK::QuickActionContext();
+        registry.addContext(context);
+
+        Model model;
+        model.setContext(context);
+        model.setId("test.save");
+        QCOMPARE(model.rowCount(), 1);
+
+        delete context;
+        QCOMPARE(model.rowCount(), 0);
+        QVERIFY(!model.context());
+    }
+};
+
+QTEST_MAIN(Test)
+
+#include "main.moc"
@@ -0,0 +1,59 @@
+#ifndef TESTEXTENSION_H
+#define TESTEXTENSION_H
+
+#include <QAKCore/private/actionextension_p.h>
+
+// The actions shared by the tests, "Ctrl+K" is both a shortcut and the prefix of a chord
+inline const QAK::ActionExtension *testActionExtension() {
+    using namespace QAK;
+    static ActionItemInfoData staticItems[] = {
+        {
+         QStringLiteral("test.save"),
+         ActionItemInfo::Action,
+         QStringLiteral("Save"),
+         QStringLiteral("File"), {}, {},
+         {QKeySequence(QStringLiteral("Ctrl+S"))},
+         {}, false, {}, {},
+         },
+        {
+         QStringLiteral("test.saveAll"),
+         ActionItemInfo::Action,
+         QStringLiteral("Save All"),
+         QStringLiteral("File"), {}, {},
+         {QKeySequence(QStringLiteral("Ctrl+K, Ctrl+S"))},
+         {}, false, {}, {},
+         },
+        {
+         QStringLiteral("test.commandPalette"),
+         ActionItemInfo::Action,
+         QStringLiteral("Command Palette"),
+         QStringLiteral("View"), {}, {},
+         {QKeySequence(QStringLiteral("Ctrl+K"))},
+         {}, false, {}, {},
+         },
+        {
+         QStringLiteral("test.open"),
+         ActionItemInfo::Action,
+         QStringLiteral("Open"),
+         QStringLiteral("File"), {}, {},
+         {QKeySequence(QStringLiteral("Ctrl+O"))},
+         {}, false, {}, {},
+         },
+    };
+    static ActionExtensionData data = {
+        ACTION_EXTENSION_VERSION,
+        QStringLiteral("test"),
+        QStringLiteral("test_hash"),
+        int(sizeof(staticItems) / sizeof(ActionItemInfoData)),
+        staticItems,
+        0,
+        nullptr,
+    };
+    static ActionExtension extension{
+        {
+         &data, },
+    };
+    return &extension;
+}
+
+#endif // TESTEXTENSION_H
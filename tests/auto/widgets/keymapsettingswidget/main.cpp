@@ -0,0 +1,180 @@
+#include <QtGui/QBrush>
+#include <QtTest/QtTest>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKWidgets/keymapsettingswidget.h>
+#include <QAKWidgets/private/keymapsettingswidget_p.h>
+
+#include "testextension.h"
+
+static QStringList visibleIds(const QAK::KeymapModel &model) {
+    QStringList ids;
+    for (int i = 0; i < model.rowCount(); ++i) {
+        ids.append(model.index(i, QAK::KeymapModel::IdColumn).data().toString());
+    }
+    ids.sort();
+    return ids;
+}
+
+static int rowOf(const QAK::KeymapModel &model, const QString &id) {
+    for (int i = 0; i < model.rowCount(); ++i) {
+        if (model.index(i, QAK::KeymapModel::IdColumn).data().toString() == id)
+            return i;
+    }
+    return -1;
+}
+
+static QString nativeKeys(const QString &keys) {
+    return QKeySequence(keys).toString(QKeySequence::NativeText);
+}
+
+class Test : public QObject {
+    Q_OBJECT
+public:
+    explicit Test(QObject *parent = nullptr) : QObject(parent) {
+    }
+
+private Q_SLOTS:
+    void testRegistry() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+
+        QAK::KeymapSettingsWidget widget;
+        QVERIFY(!widget.registry());
+        widget.setRegistry(&registry);
+        QCOMPARE(widget.registry(), &registry);
+        QVERIFY(!widget.isModified());
+    }
+
+    void testFilter() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::KeymapModel model;
+        model.setRegistry(&registry);
+        QCOMPARE(model.rowCount(), 4);
+        QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+        QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+        model.setFilter("class:view");
+        QCOMPARE(visibleIds(model), QStringList({"test.commandPalette"}));
+        model.setFilter("text:save");
+        QCOMPARE(visibleIds(model), QStringList({"test.save", "test.saveAll"}));
+        model.setFilter("ID: test.o");
+        QCOMPARE(visibleIds(model), QStringList({"test.open"}));
+        model.setFilter("key:ctrl+k");
+        QCOMPARE(visibleIds(model), QStringList({"test.commandPalette", "test.saveAll"}));
+
+        // Without a prefix every column is searched, a refinement narrows the rows shown
+        model.setFilter("e");
+        QCOMPARE(model.rowCount(), 4);
+        model.setFilter("fi");
+        QCOMPARE(visibleIds(model), QStringList({"test.open", "test.save", "test.saveAll"}));
+        model.setFilter("fil");
+        QCOMPARE(visibleIds(model), QStringList({"test.open", "test.save", "test.saveAll"}));
+
+        model.setFilter({});
+        QCOMPARE(model.rowCount(), 4);
+
+        // The rows are removed and inserted instead of resetting the model
+        QCOMPARE(reset.count(), 0);
+        QVERIFY(!removed.isEmpty());
+        QVERIFY(!inserted.isEmpty());
+        removed.clear();
+        inserted.clear();
+        model.setFilter("text:save");
+        QCOMPARE(inserted.count(), 0);
+        int removedRows = 0;
+        for (const auto &args : std::as_const(removed)) {
+            removedRows += args.at(2).toInt() - args.at(1).toInt() + 1;
+        }
+        QCOMPARE(removedRows, 2);
+        removed.clear();
+        model.setFilter("text:sav");
+        QCOMPARE(removed.count(), 0);
+        QCOMPARE(inserted.count(), 0);
+    }
+
+    void testConflicts() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        QAK::KeymapModel model;
+        model.setRegistry(&registry);
+
+        const auto saveKeys = model.index(rowOf(model, "test.save"), QAK::KeymapModel::ShortcutsColumn);
+        const auto openKeys = model.index(rowOf(model, "test.open"), QAK::KeymapModel::ShortcutsColumn);
+        const auto paletteKeys = model.index(rowOf(model, "test.commandPalette"), QAK::KeymapModel::ShortcutsColumn);
+        const auto saveAllKeys = model.index(rowOf(model, "test.saveAll"), QAK::KeymapModel::ShortcutsColumn);
+        QVERIFY(!saveKeys.data(Qt::ForegroundRole).isValid());
+        QVERIFY(!saveKeys.data(Qt::ToolTipRole).isValid());
+
+        // "Ctrl+K" is the chord prefix of "Ctrl+K, Ctrl+S"
+        QCOMPARE(paletteKeys.data(Qt::ForegroundRole).value<QBrush>(), QBrush(Qt::red));
+        QCOMPARE(saveAllKeys.data(Qt::ForegroundRole).value<QBrush>(), QBrush(Qt::red));
+        QVERIFY(paletteKeys.data(Qt::ToolTipRole).toString().contains(nativeKeys("Ctrl+K")));
+
+        QSignalSpy modified(&model, &QAK::KeymapModel::modifiedChanged);
+        QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+        QVERIFY(model.setData(openKeys, nativeKeys("Ctrl+S")));
+        QVERIFY(model.isModified());
+        QCOMPARE(modified.count(), 1);
+        QCOMPARE(saveKeys.data(Qt::ForegroundRole).value<QBrush>(), QBrush(Qt::red));
+        QCOMPARE(openKeys.data(Qt::ForegroundRole).value<QBrush>(), QBrush(Qt::red));
+        QVERIFY(saveKeys.data(Qt::ToolTipRole).toString().contains(nativeKeys("Ctrl+S")));
+
+        // Only the edited row and the row it conflicts with are repainted
+        QSet<int> changedRows;
+        for (const auto &args : std::as_const(changed)) {
+            const auto topLeft = args.at(0).value<QModelIndex>();
+            const auto bottomRight = args.at(1).value<QModelIndex>();
+            QCOMPARE(topLeft.row(), bottomRight.row());
+            changedRows.insert(topLeft.row());
+        }
+        QCOMPARE(changedRows, QSet<int>({saveKeys.row(), openKeys.row()}));
+
+        // Resetting one side resolves the conflict of both
+        model.resetRow(openKeys.row());
+        QVERIFY(!saveKeys.data(Qt::ForegroundRole).isValid());
+        QVERIFY(!openKeys.data(Qt::ForegroundRole).isValid());
+        QCOMPARE(openKeys.data().toString(), nativeKeys("Ctrl+O"));
+        QVERIFY(!model.isModified());
+        QCOMPARE(modified.count(), 2);
+
+        // Moving the prefix away resolves the ambiguity
+        QVERIFY(model.setData(paletteKeys, nativeKeys("Ctrl+Shift+P")));
+        QVERIFY(!paletteKeys.data(Qt::ForegroundRole).isValid());
+        QVERIFY(!saveAllKeys.data(Qt::ForegroundRole).isValid());
+        QVERIFY(model.setData(saveKeys, nativeKeys("Ctrl+Shift+P, Ctrl+S")));
+        QCOMPARE(paletteKeys.data(Qt::ForegroundRole).value<QBrush>(), QBrush(Qt::red));
+        QCOMPARE(saveKeys.data(Qt::ForegroundRole).value<QBrush>(), QBrush(Qt::red));
+    }
+
+    void testMergedFamily() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.setShortcuts("test.commandPalette", QList<QKeySequence>({QKeySequence("Ctrl+Shift+P")}));
+        QAK::KeymapModel model;
+        model.setRegistry(&registry);
+        QCOMPARE(model.mergedFamily(), registry.shortcutsFamily());
+
+        QVERIFY(model.setData(model.index(rowOf(model, "test.open"), QAK::KeymapModel::ShortcutsColumn),
+                              nativeKeys("Ctrl+Shift+O")));
+        // Keys equal to the defaults do not produce an override
+        QVERIFY(model.setData(model.index(rowOf(model, "test.save"), QAK::KeymapModel::ShortcutsColumn),
+                              nativeKeys("Ctrl+S")));
+        // Resetting drops the override of the registry
+        model.resetRow(rowOf(model, "test.commandPalette"));
+        QCOMPARE(model.mergedFamily(), QAK::ActionFamily::ShortcutsFamily({
+                                           {"test.open", QList<QKeySequence>({QKeySequence("Ctrl+Shift+O")})},
+        }));
+
+        model.clearEdits();
+        QVERIFY(!model.isModified());
+        model.reload();
+        QCOMPARE(model.mergedFamily(), registry.shortcutsFamily());
+    }
+};
+
+QTEST_MAIN(Test)
+
+#include "main.moc"
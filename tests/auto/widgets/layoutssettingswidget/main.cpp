@@ -0,0 +1,165 @@
+#include <set>
+
+#include <QtTest/QtTest>
+#include <QtWidgets/QTreeView>
+
+#include <QAKCore/actioncontext.h>
+#include <QAKCore/actionlayoutsmodel.h>
+#include <QAKCore/actionregistry.h>
+#include <QAKWidgets/layoutssettingswidget.h>
+
+#include "testextension.h"
+
+using Entry = QAK::ActionLayoutEntry;
+using Update = QPair<QAK::ActionElement, std::set<QString>>;
+
+static std::set<QString> stringListToSet(const QStringList &list) {
+    std::set<QString> set;
+    for (const auto &str : list) {
+        set.insert(str);
+    }
+    return set;
+}
+
+static Entry entryOf(const QModelIndex &index) {
+    return index.data(Qt::UserRole).value<Entry>();
+}
+
+class TestActionContext : public QAK::ActionContext {
+public:
+    void updateElement(QAK::ActionElement element) override {
+        updates.append({element, {}});
+    }
+    void updateActions(QAK::ActionElement element, const QStringList &ids) override {
+        updates.append({element, stringListToSet(ids)});
+    }
+
+    QList<Update> updates;
+};
+
+class Test : public QObject {
+    Q_OBJECT
+public:
+    explicit Test(QObject *parent = nullptr) : QObject(parent) {
+    }
+
+private:
+    // "test.save" is the root, "test.commandPalette" a submenu of it
+    static void setUpLayouts(QAK::ActionRegistry &registry, TestActionContext &context) {
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry("test.commandPalette", Entry::Menu)}},
+            {"test.commandPalette", {Entry("test.saveAll"), Entry("test.open")}},
+        });
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+        context.updates.clear();
+    }
+
+private Q_SLOTS:
+    void testLoad() {
+        QAK::ActionRegistry registry;
+        TestActionContext context;
+        setUpLayouts(registry, context);
+
+        QAK::LayoutsSettingsWidget widget;
+        widget.setRegistry(&registry);
+        const auto model = widget.model();
+        QCOMPARE(model->rowCount(), 1);
+        const auto save = model->index(0, 0);
+        QCOMPARE(entryOf(save).id(), "test.save");
+        QCOMPARE(model->rowCount(save), 2);
+        const auto palette = model->index(1, 0, save);
+        QCOMPARE(entryOf(palette), Entry("test.commandPalette", Entry::Menu));
+        QCOMPARE(model->rowCount(palette), 2);
+        QVERIFY(!widget.isModified());
+    }
+
+    void testMoveRows() {
+        QAK::ActionRegistry registry;
+        TestActionContext context;
+        setUpLayouts(registry, context);
+
+        QAK::LayoutsSettingsWidget widget;
+        widget.setRegistry(&registry);
+        QSignalSpy modified(&widget, &QAK::LayoutsSettingsWidget::modifiedChanged);
+        const auto model = widget.model();
+        const auto save = model->index(0, 0);
+        const auto palette = model->index(1, 0, save);
+
+        // Only the edited node is patched
+        QVERIFY(model->moveRows(palette, 1, 1, palette, 0));
+        QVERIFY(widget.isModified());
+        QCOMPARE(modified.count(), 1);
+        QCOMPARE(modified.takeFirst().at(0).toBool(), true);
+        widget.apply();
+        QVERIFY(!widget.isModified());
+        QCOMPARE(modified.takeFirst().at(0).toBool(), false);
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Layouts, {"test.commandPalette"}}}));
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.commandPalette"),
+                 QVector<Entry>({Entry("test.open"), Entry("test.saveAll")}));
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.save"),
+                 QVector<Entry>({Entry("test.open"), Entry("test.commandPalette", Entry::Menu)}));
+        context.updates.clear();
+
+        // A move across menus patches both nodes
+        QVERIFY(model->moveRows(palette, 1, 1, save, 0));
+        widget.apply();
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Layouts, {"test.save", "test.commandPalette"}}}));
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.save"),
+                 QVector<Entry>({Entry("test.saveAll"), Entry("test.open"), Entry("test.commandPalette", Entry::Menu)}));
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.commandPalette"),
+                 QVector<Entry>({Entry("test.open")}));
+        context.updates.clear();
+
+        // An edit undone by hand patches nothing
+        QVERIFY(model->moveRows(save, 0, 1, save, 2));
+        QVERIFY(model->moveRows(save, 1, 1, save, 0));
+        QVERIFY(widget.isModified());
+        widget.apply();
+        QVERIFY(!widget.isModified());
+        QVERIFY(context.updates.isEmpty());
+    }
+
+    void testInsertEntry() {
+        QAK::ActionRegistry registry;
+        TestActionContext context;
+        setUpLayouts(registry, context);
+
+        QAK::LayoutsSettingsWidget widget;
+        widget.setRegistry(&registry);
+        const auto model = widget.model();
+        const auto view = widget.findChild<QTreeView *>();
+        QVERIFY(view);
+        const auto save = model->index(0, 0);
+
+        // Inserted after the current entry
+        view->setCurrentIndex(model->index(0, 0, save));
+        widget.insertSeparator();
+        QVERIFY(widget.isModified());
+        QCOMPARE(model->rowCount(save), 3);
+        QCOMPARE(entryOf(view->currentIndex()), Entry({}, Entry::Separator));
+
+        widget.apply();
+        QCOMPARE(context.updates, QList<Update>({{QAK::AE_Layouts, {"test.save"}}}));
+        QCOMPARE(registry.layouts().adjacencyMap().value("test.save"),
+                 QVector<Entry>({Entry("test.open"), Entry({}, Entry::Separator),
+                                 Entry("test.commandPalette", Entry::Menu)}));
+        context.updates.clear();
+
+        // Removed again, the node is back to the registry state after a load
+        view->selectionModel()->select(view->currentIndex(),
+                                       QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+        widget.removeSelected();
+        QCOMPARE(model->rowCount(save), 2);
+        QVERIFY(widget.isModified());
+        widget.load();
+        QVERIFY(!widget.isModified());
+        QCOMPARE(model->rowCount(model->index(0, 0)), 3);
+        QVERIFY(context.updates.isEmpty());
+    }
+};
+
+QTEST_MAIN(Test)
+
+#include "main.moc"
@@ -0,0 +1,197 @@
+#include <QtTest/QtTest>
+#include <QtWidgets/QMenu>
+
+#include <QAKCore/actionregistry.h>
+#include <QAKWidgets/widgetactioncontext.h>
+
+#include "testextension.h"
+
+using Entry = QAK::ActionLayoutEntry;
+
+// The menu action of a submenu is a child of the submenu
+static QMenu *subMenuOf(QAction *action) {
+    return qobject_cast<QMenu *>(action->parent());
+}
+
+class Test : public QObject {
+    Q_OBJECT
+public:
+    explicit Test(QObject *parent = nullptr) : QObject(parent) {
+    }
+
+private Q_SLOTS:
+    void testPatchReuse() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry("test.commandPalette", Entry::Menu),
+                           Entry({}, Entry::Separator), Entry("test.saveAll")}},
+            {"test.commandPalette", {Entry("test.saveAll")}},
+        });
+        QMenu menu;
+        QAK::WidgetActionContext context;
+        context.addMenu("test.save", &menu);
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+
+        const auto actions = menu.actions();
+        QCOMPARE(actions.size(), 4);
+        const auto open = actions.at(0);
+        const auto subMenu = subMenuOf(actions.at(1));
+        const auto saveAll = actions.at(3);
+        QVERIFY(subMenu);
+        QVERIFY(actions.at(2)->isSeparator());
+        QCOMPARE(open->text(), "Open");
+        QCOMPARE(subMenu->title(), "Command Palette");
+        // An id shown in several containers has one action
+        QCOMPARE(subMenu->actions(), QList<QAction *>({saveAll}));
+
+        // The patch reorders the existing objects instead of creating new ones
+        registry.patchLayouts({
+            {"test.save", {Entry("test.saveAll"), Entry("test.commandPalette", Entry::Menu), Entry("test.open")}},
+        });
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(menu.actions(), QList<QAction *>({saveAll, subMenu->menuAction(), open}));
+        QCOMPARE(subMenu->actions(), QList<QAction *>({saveAll}));
+
+        // An action no longer shown anywhere is deleted
+        QPointer<QAction> dropped = open;
+        registry.patchLayouts({
+            {"test.save", {Entry("test.saveAll"), Entry("test.commandPalette", Entry::Menu)}},
+        });
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(menu.actions(), QList<QAction *>({saveAll, subMenu->menuAction()}));
+        QTRY_VERIFY(!dropped);
+    }
+
+    void testRemove() {
+        QAK::WidgetActionContext context;
+        QSignalSpy triggered(&context, &QAK::WidgetActionContext::actionTriggered);
+
+        QAction action;
+        context.addAction("test.open", &action);
+        action.trigger();
+        QCOMPARE(triggered.count(), 1);
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.open");
+
+        context.remove("test.open");
+        QVERIFY(!context.action("test.open"));
+        action.trigger();
+        QCOMPARE(triggered.count(), 0);
+
+        // The action stays connected for the ids it is still registered with
+        context.addAction("test.open", &action);
+        context.addAction("test.save", &action);
+        context.remove("test.open");
+        action.trigger();
+        QCOMPARE(triggered.count(), 1);
+        QCOMPARE(triggered.takeFirst().at(0).toString(), "test.save");
+
+        // A replaced action is disconnected
+        QAction replacement;
+        context.addAction("test.save", &replacement);
+        action.trigger();
+        QCOMPARE(triggered.count(), 0);
+        replacement.trigger();
+        QCOMPARE(triggered.count(), 1);
+    }
+
+    void testRemoveContainer() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry({}, Entry::Separator), Entry("test.saveAll")}},
+        });
+        QMenu menu;
+        menu.addAction("Application");
+        QAK::WidgetActionContext context;
+        context.addMenu("test.save", &menu);
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(menu.actions().size(), 4);
+
+        // The container is given back without the built actions
+        context.remove("test.save");
+        QCOMPARE(menu.actions().size(), 1);
+        QCOMPARE(menu.actions().at(0)->text(), "Application");
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(menu.actions().size(), 1);
+    }
+
+    void testLazySubmenus() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.commandPalette", Entry::Menu)}},
+            {"test.commandPalette", {Entry("test.open"), Entry("test.saveAll")}},
+        });
+        QMenu menu;
+        QAK::WidgetActionContext context;
+        context.setAttribute(QAK::WidgetActionContext::LazySubmenus);
+        context.addMenu("test.save", &menu);
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+
+        QCOMPARE(menu.actions().size(), 1);
+        const auto subMenu = subMenuOf(menu.actions().at(0));
+        QVERIFY(subMenu);
+        QVERIFY(subMenu->actions().isEmpty());
+
+        // Populated on the first open
+        emit subMenu->aboutToShow();
+        QCOMPARE(subMenu->actions().size(), 2);
+        QCOMPARE(subMenu->actions().at(0)->text(), "Open");
+        QCOMPARE(context.menuOpenCounts().value("test.commandPalette"), 1);
+        const auto open = subMenu->actions().at(0);
+
+        // A patch waits for the next open and keeps the existing actions
+        registry.patchLayouts({
+            {"test.commandPalette", {Entry("test.open")}},
+        });
+        registry.updateContext(QAK::AE_Layouts);
+        QCOMPARE(subMenu->actions().size(), 2);
+        emit subMenu->aboutToShow();
+        QCOMPARE(subMenu->actions(), QList<QAction *>({open}));
+        QCOMPARE(context.menuOpenCounts().value("test.commandPalette"), 2);
+    }
+
+    void testUpdateIds() {
+        QAK::ActionRegistry registry;
+        registry.setExtensions({testActionExtension()});
+        registry.patchLayouts({
+            {"test.save", {Entry("test.open"), Entry("test.saveAll")}},
+        });
+        QMenu menu;
+        QAK::WidgetActionContext context;
+        context.addMenu("test.save", &menu);
+        registry.addContext(&context);
+        registry.updateContext(QAK::AE_Layouts);
+        registry.updateContext(QAK::AE_Keymap);
+
+        const auto open = menu.actions().at(0);
+        const auto saveAll = menu.actions().at(1);
+        QCOMPARE(open->shortcut(), QKeySequence("Ctrl+O"));
+        QCOMPARE(saveAll->shortcut(), QKeySequence("Ctrl+K, Ctrl+S"));
+
+        // Marks the actions, only the refreshed ones lose the marks
+        open->setText("Marked");
+        saveAll->setText("Marked");
+        saveAll->setShortcut(QKeySequence("F1"));
+
+        registry.setShortcuts("test.open", QList<QKeySequence>({QKeySequence("Ctrl+Shift+O")}));
+        registry.updateContext(QAK::AE_Keymap);
+        QCOMPARE(open->shortcut(), QKeySequence("Ctrl+Shift+O"));
+        QCOMPARE(saveAll->shortcut(), QKeySequence("F1"));
+
+        context.updateActions(QAK::AE_Texts, {"test.open"});
+        QCOMPARE(open->text(), "Open");
+        QCOMPARE(saveAll->text(), "Marked");
+
+        context.updateElement(QAK::AE_Texts);
+        QCOMPARE(saveAll->text(), "Save All");
+    }
+};
+
+QTEST_MAIN(Test)
+
+#include "main.moc"